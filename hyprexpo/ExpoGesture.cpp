@@ -11,11 +11,13 @@ void CExpoGesture::begin(const ITrackpadGesture::STrackpadGestureBegin& e) {
     m_lastDelta   = 0.F;
     m_firstUpdate = true;
 
-    if (!g_pOverview)
-        g_pOverview = std::make_unique<COverview>(g_pCompositor->m_lastMonitor->m_activeWorkspace);
+    if (g_pOverviews.empty())
+        openOverviews();
     else {
-        g_pOverview->selectHoveredWorkspace();
-        g_pOverview->setClosing(true);
+        forEachOverview([](COverview& overview) {
+            overview.selectHoveredWorkspace();
+            overview.setClosing(true);
+        });
     }
 }
 
@@ -30,11 +32,13 @@ void CExpoGesture::update(const ITrackpadGesture::STrackpadGestureUpdate& e) {
     if (m_lastDelta <= 0.01) // plugin will crash if swipe ends at <= 0
         m_lastDelta = 0.01;
 
-    g_pOverview->onSwipeUpdate(m_lastDelta);
+    forEachOverview([this](COverview& overview) { overview.onSwipeUpdate(m_lastDelta); });
 }
 
 void CExpoGesture::end(const ITrackpadGesture::STrackpadGestureEnd& e) {
-    g_pOverview->setClosing(false);
-    g_pOverview->onSwipeEnd();
-    g_pOverview->resetSwipe();
+    forEachOverview([](COverview& overview) {
+        overview.setClosing(false);
+        overview.onSwipeEnd();
+        overview.resetSwipe();
+    });
 }
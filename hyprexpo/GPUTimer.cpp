@@ -0,0 +1,85 @@
+#include "GPUTimer.hpp"
+
+#include <GLES2/gl2ext.h>
+#include <cstring>
+
+CGPUTimer::CGPUTimer(const std::string& name) : m_name(name) {
+    const auto EXTENSIONS = (const char*)glGetString(GL_EXTENSIONS);
+
+    if (!EXTENSIONS || !std::strstr(EXTENSIONS, "GL_EXT_disjoint_timer_query")) {
+        Debug::log(LOG, "[he] no GL_EXT_disjoint_timer_query, can't time {}", m_name);
+        return;
+    }
+
+    glGenQueries(QUERIES, m_queries.data());
+}
+
+CGPUTimer::~CGPUTimer() {
+    if (good())
+        glDeleteQueries(QUERIES, m_queries.data());
+}
+
+bool CGPUTimer::good() {
+    return m_queries[0] != 0;
+}
+
+void CGPUTimer::begin() {
+    if (!good() || m_running)
+        return;
+
+    collect();
+
+    // every query is still in flight, skip this frame instead of waiting
+    if (m_pending[m_next])
+        return;
+
+    glBeginQuery(GL_TIME_ELAPSED_EXT, m_queries[m_next]);
+    m_running = true;
+}
+
+void CGPUTimer::end() {
+    if (!m_running)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED_EXT);
+    m_running         = false;
+    m_pending[m_next] = true;
+    m_next            = (m_next + 1) % QUERIES;
+}
+
+void CGPUTimer::collect() {
+    // a disjoint operation (clock change, power state) makes every result in flight meaningless
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+    for (size_t i = 0; i < QUERIES; ++i) {
+        if (!m_pending[i])
+            continue;
+
+        GLuint available = 0;
+        glGetQueryObjectuiv(m_queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (!available)
+            continue;
+
+        m_pending[i] = false;
+
+        if (disjoint)
+            continue;
+
+        // ns, 32 bits last for 4s which is plenty for one pass
+        GLuint ns = 0;
+        glGetQueryObjectuiv(m_queries[i], GL_QUERY_RESULT, &ns);
+
+        m_totalNs += ns;
+        m_samples++;
+    }
+
+    if (m_samples < LOG_EVERY)
+        return;
+
+    Debug::log(LOG, "[he] {}: {:.1f}us of GPU time on average over {} frames", m_name, m_totalNs / 1000.0 / m_samples, m_samples);
+
+    m_totalNs = 0;
+    m_samples = 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#define WLR_USE_UNSTABLE
+
+#include "globals.hpp"
+#include <GLES3/gl32.h>
+#include <array>
+#include <string>
+
+// Measures GPU time spent between begin() and end() with GL_EXT_disjoint_timer_query and logs the average
+// every LOG_EVERY frames. Results are read a few frames late, so measuring never stalls the pipeline.
+class CGPUTimer {
+  public:
+    CGPUTimer(const std::string& name);
+    ~CGPUTimer();
+
+    // false if the driver has no timer queries, begin() and end() do nothing then
+    bool good();
+
+    void begin();
+    void end();
+
+  private:
+    void                        collect();
+
+    static constexpr size_t     QUERIES   = 4;
+    static constexpr uint64_t   LOG_EVERY = 120;
+
+    std::string                 m_name;
+    std::array<GLuint, QUERIES> m_queries = {};
+    std::array<bool, QUERIES>   m_pending = {};
+    size_t                      m_next    = 0;
+    bool                        m_running = false;
+
+    uint64_t                    m_totalNs = 0;
+    uint64_t                    m_samples = 0;
+};
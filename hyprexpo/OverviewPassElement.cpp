@@ -2,12 +2,12 @@
 #include <hyprland/src/render/OpenGL.hpp>
 #include "overview.hpp"
 
-COverviewPassElement::COverviewPassElement() {
+COverviewPassElement::COverviewPassElement(COverview* overview) : m_overview(overview) {
     ;
 }
 
 void COverviewPassElement::draw(const CRegion& damage) {
-    g_pOverview->fullRender();
+    m_overview->fullRender();
 }
 
 bool COverviewPassElement::needsLiveBlur() {
@@ -19,15 +19,15 @@ bool COverviewPassElement::needsPrecomputeBlur() {
 }
 
 std::optional<CBox> COverviewPassElement::boundingBox() {
-    if (!g_pOverview->pMonitor)
+    if (!m_overview->pMonitor)
         return std::nullopt;
 
-    return CBox{{}, g_pOverview->pMonitor->m_size};
+    return CBox{{}, m_overview->pMonitor->m_size};
 }
 
 CRegion COverviewPassElement::opaqueRegion() {
-    if (!g_pOverview->pMonitor)
+    if (!m_overview->pMonitor)
         return CRegion{};
 
-    return CBox{{}, g_pOverview->pMonitor->m_size};
+    return CBox{{}, m_overview->pMonitor->m_size};
 }
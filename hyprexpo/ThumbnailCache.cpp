@@ -0,0 +1,95 @@
+#include "ThumbnailCache.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <hyprland/src/render/Renderer.hpp>
+
+CThumbnailCache::~CThumbnailCache() {
+    g_pHyprRenderer->makeEGLCurrent();
+    m_thumbnails.clear(); // otherwise we get a vram leak
+}
+
+SP<SThumbnail> CThumbnailCache::get(WORKSPACEID id, MONITORID monitor) {
+    auto& thumbnail = m_thumbnails[{id, monitor}];
+
+    if (!thumbnail) {
+        thumbnail              = makeShared<SThumbnail>();
+        thumbnail->workspaceID = id;
+        thumbnail->monitorID   = monitor;
+    }
+
+    thumbnail->lastUsed = ++m_useClock;
+
+    return thumbnail;
+}
+
+bool CThumbnailCache::isCurrent(const SThumbnail& thumbnail, const Vector2D& size) {
+    return thumbnail.valid && thumbnail.fb.m_size == size && thumbnail.generation == m_generations[thumbnail.workspaceID];
+}
+
+void CThumbnailCache::markRendered(SThumbnail& thumbnail) {
+    thumbnail.valid      = true;
+    thumbnail.generation = m_generations[thumbnail.workspaceID];
+}
+
+void CThumbnailCache::onWorkspaceDamaged(WORKSPACEID id) {
+    m_generations[id]++;
+}
+
+void CThumbnailCache::onWorkspaceDestroyed(WORKSPACEID id) {
+    m_generations.erase(id);
+
+    g_pHyprRenderer->makeEGLCurrent();
+
+    for (auto it = m_thumbnails.begin(); it != m_thumbnails.end();) {
+        if (it->first.first != id) {
+            ++it;
+            continue;
+        }
+
+        // still on screen, the overview will let go of it. The id may be reused by a new workspace until then.
+        if (it->second.strongRef() > 1) {
+            it->second->valid = false;
+            ++it;
+            continue;
+        }
+
+        it = m_thumbnails.erase(it);
+    }
+}
+
+void CThumbnailCache::evict() {
+    static auto* const* PBUDGET = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:cache_budget")->getDataStaticPtr();
+
+    const size_t             BUDGET = std::max<Hyprlang::INT>(**PBUDGET, 0) * 1024 * 1024;
+
+    size_t                   used = 0;
+    std::vector<SThumbnail*> unused;
+
+    for (auto& [id, thumbnail] : m_thumbnails) {
+        used += thumbnail->bytes();
+
+        if (thumbnail.strongRef() == 1)
+            unused.push_back(thumbnail.get());
+    }
+
+    if (used <= BUDGET)
+        return;
+
+    std::ranges::sort(unused, {}, &SThumbnail::lastUsed);
+
+    g_pHyprRenderer->makeEGLCurrent();
+
+    for (auto* thumbnail : unused) {
+        if (used <= BUDGET)
+            break;
+
+        used -= thumbnail->bytes();
+        m_thumbnails.erase({thumbnail->workspaceID, thumbnail->monitorID});
+    }
+}
+
+bool CThumbnailCache::empty() const {
+    return m_thumbnails.empty();
+}
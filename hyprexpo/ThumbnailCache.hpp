@@ -0,0 +1,73 @@
+#pragma once
+
+#define WLR_USE_UNSTABLE
+
+#include "globals.hpp"
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <hyprland/src/render/Framebuffer.hpp>
+#include <map>
+#include <vector>
+#include <unordered_map>
+
+// One rendered workspace, for one monitor. Stale once its workspace got damaged after it was rendered.
+struct SThumbnail {
+    CFramebuffer fb;
+    WORKSPACEID  workspaceID = WORKSPACE_INVALID;
+    MONITORID    monitorID   = MONITOR_INVALID;
+    bool         valid       = false;           // rendered at least once
+    uint64_t     generation  = 0;               // of the workspace, when rendered
+    uint64_t     lastUsed    = 0;
+
+    // with plugin:hyprexpo:mipmaps, box-filtered copies of fb, each half the size of the one before
+    std::vector<UP<CFramebuffer>> mips;
+
+    // the smallest of fb and its mips that is still at least width px wide, so drawing it never minifies by 2x or more
+    CFramebuffer& levelFor(double width) {
+        for (auto it = mips.rbegin(); it != mips.rend(); ++it) {
+            if ((*it)->m_size.x >= width)
+                return **it;
+        }
+
+        return fb;
+    }
+
+    // vram, assuming 4 bytes per px
+    size_t bytes() const {
+        size_t total = fb.m_size.x * fb.m_size.y * 4;
+        for (const auto& mip : mips) {
+            total += mip->m_size.x * mip->m_size.y * 4;
+        }
+        return total;
+    }
+};
+
+// Workspace thumbnails, kept across overview sessions so re-opening only re-renders what changed.
+// Thumbnails nobody uses are evicted least recently used first once over plugin:hyprexpo:cache_budget.
+class CThumbnailCache {
+  public:
+    ~CThumbnailCache();
+
+    // creates the thumbnail if needed. Every monitor has its own, a workspace can show up in the overviews of several.
+    SP<SThumbnail> get(WORKSPACEID id, MONITORID monitor);
+
+    // whether thumbnail shows the current state of its workspace, at size
+    bool isCurrent(const SThumbnail& thumbnail, const Vector2D& size);
+
+    void markRendered(SThumbnail& thumbnail);
+
+    // makes every thumbnail of this workspace stale
+    void onWorkspaceDamaged(WORKSPACEID id);
+    void onWorkspaceDestroyed(WORKSPACEID id);
+
+    // drops unused thumbnails until we're within budget
+    void evict();
+
+    bool empty() const;
+
+  private:
+    std::map<std::pair<WORKSPACEID, MONITORID>, SP<SThumbnail>> m_thumbnails;
+    std::unordered_map<WORKSPACEID, uint64_t>                   m_generations;
+    uint64_t                                                    m_useClock = 0;
+};
+
+inline UP<CThumbnailCache> g_pThumbnailCache;
@@ -0,0 +1,204 @@
+#include "TileAtlas.hpp"
+
+#include <hyprland/src/helpers/Monitor.hpp>
+#include <hyprland/src/render/OpenGL.hpp>
+#include <hyprland/src/render/Renderer.hpp>
+
+#include "shaders.hpp"
+
+struct STileShader {
+    GLuint program     = 0;
+    GLint  proj        = -1;
+    GLint  tex         = -1;
+    GLint  sideLength  = -1;
+    GLint  monitorSize = -1;
+    GLint  origin      = -1;
+    GLint  tileSize    = -1;
+    GLint  stride      = -1;
+    GLint  atlasTexel  = -1;
+    bool   failed      = false; // don't retry every open
+};
+
+static STileShader g_tileShader;
+
+static GLuint compileShader(GLuint type, const std::string& src) {
+    auto        shader       = glCreateShader(type);
+    const char* shaderSource = src.c_str();
+
+    glShaderSource(shader, 1, &shaderSource, nullptr);
+    glCompileShader(shader);
+
+    GLint ok;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+
+    if (ok == GL_FALSE) {
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+static bool createShader() {
+    if (g_tileShader.program)
+        return true;
+
+    if (g_tileShader.failed)
+        return false;
+
+    const auto VERT = compileShader(GL_VERTEX_SHADER, TILEGRID);
+    const auto FRAG = compileShader(GL_FRAGMENT_SHADER, FRAGTILEGRID);
+
+    GLint      ok = GL_FALSE;
+
+    if (VERT && FRAG) {
+        g_tileShader.program = glCreateProgram();
+        glAttachShader(g_tileShader.program, VERT);
+        glAttachShader(g_tileShader.program, FRAG);
+        glLinkProgram(g_tileShader.program);
+        glDetachShader(g_tileShader.program, VERT);
+        glDetachShader(g_tileShader.program, FRAG);
+        glGetProgramiv(g_tileShader.program, GL_LINK_STATUS, &ok);
+    }
+
+    if (VERT)
+        glDeleteShader(VERT);
+    if (FRAG)
+        glDeleteShader(FRAG);
+
+    if (ok == GL_FALSE) {
+        Debug::log(ERR, "[he] couldn't build the tile shader, tiles will be drawn one by one");
+        if (g_tileShader.program)
+            glDeleteProgram(g_tileShader.program);
+        g_tileShader = {.failed = true};
+        return false;
+    }
+
+    const auto PROG          = g_tileShader.program;
+    g_tileShader.proj        = glGetUniformLocation(PROG, "proj");
+    g_tileShader.tex         = glGetUniformLocation(PROG, "tex");
+    g_tileShader.sideLength  = glGetUniformLocation(PROG, "sideLength");
+    g_tileShader.monitorSize = glGetUniformLocation(PROG, "monitorSize");
+    g_tileShader.origin      = glGetUniformLocation(PROG, "origin");
+    g_tileShader.tileSize    = glGetUniformLocation(PROG, "tileSize");
+    g_tileShader.stride      = glGetUniformLocation(PROG, "stride");
+    g_tileShader.atlasTexel  = glGetUniformLocation(PROG, "atlasTexel");
+
+    return true;
+}
+
+void CTileAtlas::destroyShader() {
+    if (g_tileShader.program)
+        glDeleteProgram(g_tileShader.program);
+
+    g_tileShader = {};
+}
+
+CTileAtlas::CTileAtlas(int sideLength, const Vector2D& slotSize, uint32_t drmFormat, const CHyprColor& emptyColor) :
+    m_sideLength(sideLength), m_slotSize(slotSize), m_emptyColor(emptyColor) {
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+
+    const Vector2D SIZE = m_slotSize * m_sideLength;
+
+    if (SIZE.x > maxSize || SIZE.y > maxSize) {
+        Debug::log(LOG, "[he] a {}x{} tile atlas is over the GPU limit of {}, tiles will be drawn one by one", SIZE.x, SIZE.y, maxSize);
+        return;
+    }
+
+    if (!createShader())
+        return;
+
+    m_fb.alloc(SIZE.x, SIZE.y, drmFormat);
+
+    clear();
+
+    // everything comes from gl_VertexID and gl_InstanceID, but we still want our own, empty, vao bound
+    glGenVertexArrays(1, &m_vao);
+}
+
+CTileAtlas::~CTileAtlas() {
+    if (m_vao)
+        glDeleteVertexArrays(1, &m_vao);
+}
+
+void CTileAtlas::clear() {
+    if (!good())
+        return;
+
+    // tiles that were never copied in show this, like the placeholders of the per-tile path
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fb.getFBID());
+    glClearColor(m_emptyColor.r, m_emptyColor.g, m_emptyColor.b, 1.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+bool CTileAtlas::good() {
+    return m_fb.isAllocated();
+}
+
+const Vector2D& CTileAtlas::slotSize() {
+    return m_slotSize;
+}
+
+void CTileAtlas::copy(int id, CFramebuffer& fb) {
+    if (!good() || id < 0 || id >= m_sideLength * m_sideLength)
+        return;
+
+    const int X = (id % m_sideLength) * m_slotSize.x;
+    const int Y = (id / m_sideLength) * m_slotSize.y;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fb.getFBID());
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_fb.getFBID());
+    glBlitFramebuffer(0, 0, fb.m_size.x, fb.m_size.y, X, Y, X + m_slotSize.x, Y + m_slotSize.y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void CTileAtlas::draw(const CRegion& damage, const Vector2D& origin, const Vector2D& tileSize, const Vector2D& stride, int tiles) {
+    tiles = std::min(tiles, m_sideLength * m_sideLength);
+
+    if (!good() || damage.empty() || tiles <= 0)
+        return;
+
+    const auto PMONITOR = g_pHyprOpenGL->m_renderData.pMonitor.lock();
+
+    CBox       monbox = {0, 0, PMONITOR->m_transformedSize.x, PMONITOR->m_transformedSize.y};
+
+    Mat3x3     matrix   = g_pHyprOpenGL->m_renderData.monitorProjection.projectBox(monbox, wlTransformToHyprutils(invertTransform(WL_OUTPUT_TRANSFORM_NORMAL)), monbox.rot);
+    Mat3x3     glMatrix = g_pHyprOpenGL->m_renderData.projection.copy().multiply(matrix);
+    glMatrix.transpose();
+
+    const auto TEX = m_fb.getTexture();
+
+    glUseProgram(g_tileShader.program);
+    glUniformMatrix3fv(g_tileShader.proj, 1, GL_FALSE, glMatrix.getMatrix().data());
+    glUniform1i(g_tileShader.tex, 0);
+    glUniform1i(g_tileShader.sideLength, m_sideLength);
+    glUniform2f(g_tileShader.monitorSize, monbox.w, monbox.h);
+    glUniform2f(g_tileShader.origin, origin.x, origin.y);
+    glUniform2f(g_tileShader.tileSize, tileSize.x, tileSize.y);
+    glUniform2f(g_tileShader.stride, stride.x, stride.y);
+    glUniform2f(g_tileShader.atlasTexel, 1.0 / m_fb.m_size.x, 1.0 / m_fb.m_size.y);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(TEX->m_target, TEX->m_texID);
+    glTexParameteri(TEX->m_target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(TEX->m_target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // tiles are opaque, put blending back the way the caller had it afterwards
+    const bool BLEND = glIsEnabled(GL_BLEND);
+    g_pHyprOpenGL->blend(false);
+
+    glBindVertexArray(m_vao);
+
+    for (auto& RECT : damage.getRects()) {
+        g_pHyprOpenGL->scissor(&RECT);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, tiles);
+    }
+
+    glBindVertexArray(0);
+    glBindTexture(TEX->m_target, 0);
+
+    g_pHyprOpenGL->scissor(nullptr);
+    g_pHyprOpenGL->blend(BLEND);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#define WLR_USE_UNSTABLE
+
+#include "globals.hpp"
+#include <hyprland/src/render/Framebuffer.hpp>
+
+// Every tile of the grid in one texture, so the overview is drawn with one instanced draw per damage rect
+// instead of one draw per tile. Tiles are copied in whenever they are rendered.
+class CTileAtlas {
+  public:
+    // slotSize is the size of one tile in px. Check good(), the GPU may not take an atlas this big.
+    CTileAtlas(int sideLength, const Vector2D& slotSize, uint32_t drmFormat, const CHyprColor& emptyColor);
+    ~CTileAtlas();
+
+    bool            good();
+    const Vector2D& slotSize();
+
+    // scales fb into the slot of tile id
+    void            copy(int id, CFramebuffer& fb);
+
+    // back to emptyColor everywhere
+    void            clear();
+
+    // draws the first tiles slots, clipped to damage. Everything is in monitor px, stride is the tile size plus the gap.
+    void            draw(const CRegion& damage, const Vector2D& origin, const Vector2D& tileSize, const Vector2D& stride, int tiles);
+
+    // frees the shader shared by all atlases, needs the EGL context
+    static void     destroyShader();
+
+  private:
+    CFramebuffer m_fb;
+    int          m_sideLength = 0;
+    Vector2D     m_slotSize;
+    CHyprColor   m_emptyColor;
+    GLuint       m_vao = 0;
+};
@@ -0,0 +1,44 @@
+#include "TileScheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <hyprland/src/Compositor.hpp>
+
+#include "overview.hpp"
+
+void CTileScheduler::queue(COverview* overview, int id) {
+    m_jobs.push_back({overview, id});
+}
+
+void CTileScheduler::forget(COverview* overview) {
+    std::erase_if(m_jobs, [overview](const auto& job) { return job.overview == overview; });
+}
+
+void CTileScheduler::onPreRender() {
+    static auto* const* PBUDGET = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:redraw_budget")->getDataStaticPtr();
+
+    if (m_jobs.empty())
+        return;
+
+    // always redraw at least one tile, then as many as fit in the budget
+    const auto BEGIN = std::chrono::steady_clock::now();
+
+    do {
+        const auto JOB = m_jobs.front();
+        m_jobs.pop_front();
+
+        JOB.overview->redrawDirty(JOB.id);
+    } while (!m_jobs.empty() && std::chrono::steady_clock::now() - BEGIN < std::chrono::milliseconds(**PBUDGET));
+
+    // the rest go in the next frame of whichever output comes first
+    std::vector<COverview*> waiting;
+    for (const auto& JOB : m_jobs) {
+        if (std::ranges::find(waiting, JOB.overview) != waiting.end())
+            continue;
+
+        waiting.push_back(JOB.overview);
+        g_pCompositor->scheduleFrameForMonitor(JOB.overview->pMonitor.lock());
+    }
+}
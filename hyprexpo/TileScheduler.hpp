@@ -0,0 +1,33 @@
+#pragma once
+
+#define WLR_USE_UNSTABLE
+
+#include "globals.hpp"
+#include <deque>
+
+class COverview;
+
+// Tile re-renders of every open overview, in one queue.
+// Tiles don't have to be rendered in their own monitor's frame, so each output's frame takes a share of the
+// queue up to plugin:hyprexpo:redraw_budget, instead of one output paying for everything shown on it.
+class CTileScheduler {
+  public:
+    // oldest first, so a tile that is damaged every frame can't starve the others
+    void queue(COverview* overview, int id);
+
+    // drops everything queued for overview
+    void forget(COverview* overview);
+
+    // from any monitor's preRender
+    void onPreRender();
+
+  private:
+    struct STileJob {
+        COverview* overview = nullptr;
+        int        id       = -1;
+    };
+
+    std::deque<STileJob> m_jobs;
+};
+
+inline UP<CTileScheduler> g_pTileScheduler;
@@ -0,0 +1,155 @@
+#include "WorkspaceOrder.hpp"
+
+#include <algorithm>
+
+CWorkspaceOrder::CWorkspaceOrder(int64_t current, std::vector<int64_t> existing, std::vector<int64_t> unavailable) :
+    m_current(current), m_existing(std::move(existing)), m_unavailable(std::move(unavailable)) {
+    std::ranges::sort(m_existing);
+    m_existing.erase(std::ranges::unique(m_existing).begin(), m_existing.end());
+
+    std::ranges::sort(m_unavailable);
+    m_unavailable.erase(std::ranges::unique(m_unavailable).begin(), m_unavailable.end());
+
+    m_named = {m_existing.begin(), std::ranges::lower_bound(m_existing, 0)};
+
+    if (const auto IT = std::ranges::lower_bound(m_existing, current); IT != m_existing.end() && *IT == current)
+        m_currentIndex = IT - m_existing.begin();
+}
+
+int64_t CWorkspaceOrder::relative(int64_t offset, bool existingOnly) const {
+    if (!existingOnly)
+        return relativeAvailable(offset);
+
+    if (m_existing.empty())
+        return m_current;
+
+    // wraps around, from just below the lowest one if current doesn't exist
+    const int64_t N = m_existing.size();
+    return m_existing[((m_currentIndex + offset) % N + N) % N];
+}
+
+int64_t CWorkspaceOrder::highest() const {
+    return m_existing.empty() ? m_current : m_existing.back();
+}
+
+size_t CWorkspaceOrder::unavailableIn(int64_t from, int64_t to) const {
+    if (from > to)
+        return 0;
+
+    return std::ranges::upper_bound(m_unavailable, to) - std::ranges::lower_bound(m_unavailable, from);
+}
+
+bool CWorkspaceOrder::isUnavailable(int64_t id) const {
+    return std::ranges::binary_search(m_unavailable, id);
+}
+
+/*
+    Follows getWorkspaceIDNameFromString step by step, quirks included, so every tile is what its selector would give.
+    It guesses current + offset, counts the unavailable ids it jumped over, then walks that many available ids further.
+    Named workspaces come before 1: r- past 1 lands on them, and r+ from one goes through the rest of them before 1.
+    The walks only visit the unavailable ids in the way, so this stays cheap for any offset.
+*/
+int64_t CWorkspaceOrder::relativeAvailable(int64_t offset) const {
+    bool    up        = offset >= 0;
+    int64_t predicted = std::max<int64_t>(m_current + offset, 0);
+    int64_t remaining = up ? unavailableIn(m_current + 1, predicted) : unavailableIn(predicted, m_current);
+
+    if (m_current < 0) {
+        // unsigned on purpose, going below the first named one wraps around to past the last one like it does in Hyprland
+        size_t item = (size_t)-1;
+        if (const auto IT = std::ranges::find(m_named, m_current); IT != m_named.end())
+            item = IT - m_named.begin();
+
+        item += offset;
+
+        if (item >= m_named.size()) {
+            // past the named ones, r+diff from an imaginary workspace 0
+            predicted = (int64_t)(item - (m_named.size() - 1));
+            remaining += unavailableIn(1, predicted);
+            up = true;
+        } else {
+            predicted = m_named[item];
+            remaining = 0;
+        }
+    }
+
+    int64_t result = predicted;
+
+    if (!up) {
+        const int64_t BEGIN = result;
+
+        for (int64_t id = result - 1; id > 0 && remaining > 0; --id) {
+            if (!isUnavailable(id))
+                remaining--;
+            result = id;
+        }
+
+        if (result <= 0 || isUnavailable(result)) {
+            if (!m_named.empty()) {
+                // the closest named one for whatever is left, also unsigned like in Hyprland
+                const size_t IDX = std::clamp<size_t>(m_named.size() - remaining, 0, m_named.size() - 1);
+                result           = m_named[IDX];
+            } else {
+                // nothing below, the first available one above where we started instead
+                result    = BEGIN;
+                remaining = 1;
+                up        = true;
+            }
+        }
+    }
+
+    if (up) {
+        for (int64_t id = result + 1; id < INT32_MAX && remaining > 0; ++id) {
+            if (!isUnavailable(id))
+                remaining--;
+            result = id;
+        }
+    }
+
+    return result;
+}
+
+std::vector<int64_t> orderTiles(const CWorkspaceOrder& order, const STileOrderParams& params) {
+    std::vector<int64_t> ids;
+    ids.reserve(params.tiles);
+
+    // r never wraps, so a scrolling grid would list empty workspaces all the way to params.tiles otherwise
+    const int64_t HIGHEST = std::max(order.highest(), params.startID);
+
+    if (params.center) {
+        int64_t firstID     = params.startID;
+        int64_t backtracked = 0;
+
+        // lower than the start until we wrap, at most half the grid
+        for (size_t i = 1; i < (params.scroll ? params.tiles : params.tiles / 2); ++i) {
+            const int64_t ID = order.relative(-(int64_t)i, params.skipEmpty);
+            if (ID >= firstID)
+                break;
+
+            backtracked++;
+            firstID = ID;
+        }
+
+        for (size_t i = 0; i < params.tiles; ++i) {
+            const int64_t OFFSET = (int64_t)i - backtracked;
+            const int64_t ID     = order.relative(OFFSET, params.skipEmpty);
+
+            if (OFFSET >= 0 && ((i > 0 && ID <= firstID) || (params.scroll && ID > HIGHEST)))
+                break;
+
+            ids.push_back(ID);
+        }
+    } else {
+        ids.push_back(params.startID);
+
+        for (size_t i = 1; i < params.tiles; ++i) {
+            const int64_t ID = order.relative(i, params.skipEmpty);
+            if (ID <= params.startID || (params.scroll && ID > HIGHEST))
+                break;
+
+            ids.push_back(ID);
+        }
+    }
+
+    return ids;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Which workspace goes in which tile, resolved from one snapshot of the monitor's workspaces taken on open,
+// instead of parsing an "r+N" or "m+N" selector per tile, each of which rescans every workspace.
+// Has no compositor dependencies, so it can be benchmarked on its own. Ids are WORKSPACEIDs.
+
+class CWorkspaceOrder {
+  public:
+    // existing are the monitor's workspaces, named ones included. unavailable are ids that can't be
+    // opened here: special ones and the ones bound to or open on other monitors.
+    // current is what everything is relative to, like the active workspace is for the selectors.
+    CWorkspaceOrder(int64_t current, std::vector<int64_t> existing, std::vector<int64_t> unavailable);
+
+    // the id of selector "m+offset" with existingOnly, of "r+offset" without
+    int64_t relative(int64_t offset, bool existingOnly) const;
+
+    // highest existing id
+    int64_t highest() const;
+
+  private:
+    int64_t              relativeAvailable(int64_t offset) const;
+    size_t               unavailableIn(int64_t from, int64_t to) const;
+    bool                 isUnavailable(int64_t id) const;
+
+    int64_t              m_current      = 0;
+    int64_t              m_currentIndex = -1; // in m_existing, -1 if current doesn't exist
+    std::vector<int64_t> m_existing;          // sorted
+    std::vector<int64_t> m_named;             // sorted, the negative ones of m_existing
+    std::vector<int64_t> m_unavailable;       // sorted
+};
+
+struct STileOrderParams {
+    bool    center    = true; // workspace_method center, otherwise first
+    int64_t startID   = 1;
+    size_t  tiles     = 9;
+    bool    skipEmpty = false;
+    bool    scroll    = false; // scroll_grid, no limit on backtracking and r stops past the highest workspace
+};
+
+// the workspace of each tile, in the order the overview lays them out. Stops where the workspaces wrap around,
+// so there may be fewer than params.tiles.
+std::vector<int64_t> orderTiles(const CWorkspaceOrder& order, const STileOrderParams& params);
@@ -0,0 +1,408 @@
+// Benchmark for assigning workspaces to tiles on open.
+// Compares orderTiles against resolving one "r+N" / "m+N" selector per tile, which is how the overview used to do it:
+// every selector is built as a string, parsed, and rescans the workspace list and workspace rules.
+// CWorkspaceOrder is first checked against what getWorkspaceIDNameFromString returns for a fixed set of workspaces,
+// then against a transcription of it for the timed ones.
+//
+// Usage: hyprexpo-bench-enumeration [workspaces]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <set>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+#include "../WorkspaceOrder.hpp"
+
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    g_allocations++;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+struct SWorkspace {
+    int64_t id      = 0;
+    int     monitor = 0;
+    bool    special = false;
+};
+
+struct SRule {
+    int64_t id      = 0;
+    int     monitor = 0;
+};
+
+struct SWorld {
+    std::vector<SWorkspace> workspaces;
+    std::vector<SRule>      rules;
+    int                     monitor = 0; // the one the overview opens on
+    int64_t                 active  = 1;
+};
+
+constexpr int RUNS = 200;
+
+// workspaces 1..count spread over two monitors with some gaps, a few named and special ones and rules binding ids elsewhere
+static SWorld makeWorld(int count) {
+    SWorld world;
+
+    for (int i = 1; i <= count; ++i) {
+        if (i % 7 == 0)
+            continue;
+
+        world.workspaces.push_back({i, i % 5 == 0 ? 1 : 0});
+    }
+
+    world.workspaces.push_back({-1337, 0});
+    world.workspaces.push_back({-1336, 0});
+    world.workspaces.push_back({-1335, 1});
+    world.workspaces.push_back({-98, 0, true});
+
+    for (int i = 3; i <= count + 20; i += 11) {
+        world.rules.push_back({i, 1});
+    }
+
+    world.active = count / 2 + (count / 2 % 5 == 0 ? 1 : 0);
+
+    return world;
+}
+
+// getWorkspaceIDNameFromString for "r+N", "r-N", "m+N" and "m-N", transcribed from Hyprland's src/helpers/MiscFunctions.cpp
+// with the compositor swapped for world. Like the real one, it rescans the workspaces and rules on every call.
+static int64_t resolveSelector(const std::string& in, const SWorld& world, int64_t active) {
+    const int64_t REMAINS = std::stoll(in.substr(1));
+
+    if (in[0] == 'm') {
+        std::vector<int64_t> validWSes;
+        for (const auto& w : world.workspaces) {
+            if (w.special || w.monitor != world.monitor)
+                continue;
+
+            validWSes.push_back(w.id);
+        }
+
+        std::ranges::sort(validWSes);
+
+        ssize_t currentItem = -1;
+        for (ssize_t i = 0; i < (ssize_t)validWSes.size(); i++) {
+            if (validWSes[i] == active) {
+                currentItem = i;
+                break;
+            }
+        }
+
+        currentItem += REMAINS;
+        currentItem = (currentItem % (ssize_t)validWSes.size() + validWSes.size()) % validWSes.size();
+        return validWSes[currentItem];
+    }
+
+    std::set<int64_t> invalidWSes;
+    for (const auto& w : world.workspaces) {
+        if (w.special || w.monitor != world.monitor)
+            invalidWSes.insert(w.id);
+    }
+
+    for (const auto& r : world.rules) {
+        if (r.monitor != world.monitor)
+            invalidWSes.insert(r.id);
+    }
+
+    std::vector<int64_t> namedWSes;
+    for (const auto& w : world.workspaces) {
+        if (w.special || w.monitor != world.monitor || w.id >= 0)
+            continue;
+
+        namedWSes.push_back(w.id);
+    }
+
+    std::ranges::sort(namedWSes);
+
+    int64_t predictedWSID = std::max<int64_t>(active + REMAINS, 0);
+    int64_t remainingWSes = 0;
+    char    walkDir       = in[1] == '-' ? '-' : '+';
+
+    const int64_t BEGINID = walkDir == '+' ? active + 1 : predictedWSID;
+    const int64_t ENDID   = walkDir == '+' ? predictedWSID : active;
+    for (auto it = invalidWSes.upper_bound(BEGINID - 1); it != invalidWSes.end() && *it <= ENDID; it++) {
+        remainingWSes++;
+    }
+
+    if (active < 0) {
+        size_t currentItem = -1;
+        for (size_t i = 0; i < namedWSes.size(); i++) {
+            if (namedWSes[i] == active) {
+                currentItem = i;
+                break;
+            }
+        }
+
+        currentItem += REMAINS;
+        if (currentItem >= namedWSes.size()) {
+            size_t diff   = currentItem - (namedWSes.size() - 1);
+            predictedWSID = diff;
+            for (auto it = invalidWSes.upper_bound(0); it != invalidWSes.end() && *it <= predictedWSID; it++) {
+                remainingWSes++;
+            }
+            walkDir = '+';
+        } else {
+            remainingWSes = 0;
+            predictedWSID = namedWSes[currentItem];
+        }
+    }
+
+    int64_t finalWSID = predictedWSID;
+    if (walkDir == '-') {
+        const int64_t BEGIN = finalWSID;
+        int64_t       curID = finalWSID;
+        while (--curID > 0 && remainingWSes > 0) {
+            if (!invalidWSes.contains(curID))
+                remainingWSes--;
+            finalWSID = curID;
+        }
+
+        if (finalWSID <= 0 || invalidWSes.contains(finalWSID)) {
+            if (namedWSes.size()) {
+                auto namedWSIdx = namedWSes.size() - remainingWSes;
+                namedWSIdx      = std::clamp(namedWSIdx, (size_t)0, namedWSes.size() - 1);
+                finalWSID       = namedWSes[namedWSIdx];
+            } else {
+                walkDir       = '+';
+                finalWSID     = BEGIN;
+                remainingWSes = 1;
+            }
+        }
+    }
+
+    if (walkDir == '+') {
+        int64_t curID = finalWSID;
+        while (++curID < INT32_MAX && remainingWSes > 0) {
+            if (!invalidWSes.contains(curID))
+                remainingWSes--;
+            finalWSID = curID;
+        }
+    }
+
+    return finalWSID;
+}
+
+// what the overview constructor did before orderTiles
+static std::vector<int64_t> orderTilesWithSelectors(const SWorld& world, const STileOrderParams& params) {
+    std::vector<int64_t> ids;
+    const std::string    selector = params.skipEmpty ? "m" : "r";
+    const int64_t        active   = params.center ? world.active : params.startID;
+
+    int64_t              highest = params.startID;
+    for (const auto& w : world.workspaces) {
+        if (!w.special && w.monitor == world.monitor)
+            highest = std::max(highest, w.id);
+    }
+    highest = std::max(highest, active);
+
+    if (params.center) {
+        int64_t firstID     = params.startID;
+        int64_t backtracked = 0;
+
+        for (size_t i = 1; i < (params.scroll ? params.tiles : params.tiles / 2); ++i) {
+            const int64_t ID = resolveSelector(selector + "-" + std::to_string(i), world, active);
+            if (ID >= firstID)
+                break;
+
+            backtracked++;
+            firstID = ID;
+        }
+
+        for (size_t i = 0; i < params.tiles; ++i) {
+            const int64_t OFFSET = (int64_t)i - backtracked;
+            const int64_t ID     = resolveSelector(selector + (OFFSET < 0 ? "" : "+") + std::to_string(OFFSET), world, active);
+
+            if (OFFSET >= 0 && ((i > 0 && ID <= firstID) || (params.scroll && ID > highest)))
+                break;
+
+            ids.push_back(ID);
+        }
+    } else {
+        ids.push_back(params.startID);
+
+        for (size_t i = 1; i < params.tiles; ++i) {
+            const int64_t ID = resolveSelector(selector + "+" + std::to_string(i), world, active);
+            if (ID <= params.startID || (params.scroll && ID > highest))
+                break;
+
+            ids.push_back(ID);
+        }
+    }
+
+    return ids;
+}
+
+static CWorkspaceOrder makeOrder(const SWorld& world, int64_t current) {
+    std::vector<int64_t> existing, unavailable;
+    for (const auto& w : world.workspaces) {
+        if (!w.special && w.monitor == world.monitor)
+            existing.push_back(w.id);
+        else
+            unavailable.push_back(w.id);
+    }
+
+    for (const auto& r : world.rules) {
+        if (r.monitor != world.monitor)
+            unavailable.push_back(r.id);
+    }
+
+    return CWorkspaceOrder{current, std::move(existing), std::move(unavailable)};
+}
+
+static std::vector<int64_t> orderTilesWithSnapshot(const SWorld& world, const STileOrderParams& params) {
+    return orderTiles(makeOrder(world, params.center ? world.active : params.startID), params);
+}
+
+struct SRecordedSelector {
+    int64_t     current = 0;
+    std::string selector;
+    int64_t     id = 0;
+};
+
+struct SRecordedWorld {
+    SWorld                         world;
+    std::vector<SRecordedSelector> selectors;
+};
+
+// What getWorkspaceIDNameFromString gives with current as the active workspace of monitor 0.
+// Worked out from Hyprland's implementation, its quirks are kept on purpose: r- stops at 1 while it still
+// has unavailable ids to skip, r- from a named workspace gives the highest named one, and r+ from a named one
+// counts the unavailable ids between it and 0 on top of the ones it jumps over.
+static std::vector<SRecordedWorld> recordedWorlds() {
+    std::vector<SRecordedWorld> worlds;
+
+    // two named workspaces here, one and 3, 5 over there, 7 bound there and a special one
+    SWorld named;
+    named.workspaces = {{1, 0}, {2, 0}, {4, 0}, {6, 0}, {9, 0}, {-1337, 0}, {-1336, 0}, {3, 1}, {5, 1}, {-1335, 1}, {-98, 0, true}};
+    named.rules      = {{7, 1}};
+
+    worlds.push_back({named,
+                      {
+                          {4, "r+0", 4},         {4, "r+1", 6},         {4, "r+2", 8},         {4, "r+3", 9},          {4, "r+4", 10},
+                          {4, "r-1", 2},         {4, "r-2", 1},         {4, "r-3", 1},         {4, "r-4", -1336},      {4, "r-5", -1336},
+                          {1, "r-1", -1336},     {1, "r+1", 2},         {1, "r+2", 4},         {9, "r+1", 10},         {9, "r-1", 8},
+                          {9, "r-3", 4},         {9, "r-6", 1},         {-1337, "r+0", -1337}, {-1337, "r+1", -1336},  {-1337, "r+2", 4},
+                          {-1337, "r+3", 6},     {-1337, "r-1", -2},    {-1336, "r-1", -1336}, {-1336, "r+1", 4},      {-1336, "r+2", 6},
+                          {4, "m+1", 6},         {4, "m+2", 9},         {4, "m+3", -1337},     {4, "m-1", 2},          {4, "m-3", -1336},
+                          {4, "m-5", 9},         {8, "m+1", -1337},     {8, "r+1", 9},
+                      }});
+
+    // no named workspaces, r- turns around when it runs out of room
+    SWorld unnamed;
+    unnamed.workspaces = {{2, 0}, {4, 0}, {1, 1}};
+
+    worlds.push_back({unnamed,
+                      {
+                          {2, "r-1", 2},
+                          {2, "r+1", 3},
+                          {4, "r-1", 3},
+                          {4, "r-2", 2},
+                          {4, "r-3", 2},
+                      }});
+
+    return worlds;
+}
+
+// both the snapshot and the transcription have to give what Hyprland does
+static bool checkRecorded() {
+    bool ok = true;
+
+    for (const auto& [world, selectors] : recordedWorlds()) {
+        for (const auto& [current, selector, id] : selectors) {
+            const int64_t OFFSET    = std::stoll(selector.substr(1));
+            const int64_t SNAPSHOT  = makeOrder(world, current).relative(OFFSET, selector[0] == 'm');
+            const int64_t SELECTORS = resolveSelector(selector, world, current);
+
+            if (SNAPSHOT != id || SELECTORS != id) {
+                std::fprintf(stderr, "%s from %lld: expected %lld, snapshot gives %lld, selectors %lld\n", selector.c_str(), (long long)current, (long long)id, (long long)SNAPSHOT,
+                             (long long)SELECTORS);
+                ok = false;
+            }
+        }
+    }
+
+    return ok;
+}
+
+struct SResult {
+    double               nsPerOpen     = 0;
+    double               allocsPerOpen = 0;
+    std::vector<int64_t> ids;
+};
+
+template <typename F>
+static SResult measure(const F& fn) {
+    SResult result;
+    result.ids = fn();
+
+    const size_t ALLOCSBEFORE = g_allocations;
+    const auto   BEGIN        = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < RUNS; ++i) {
+        const auto IDS = fn();
+        if (IDS.empty())
+            std::abort();
+    }
+
+    const auto END = std::chrono::steady_clock::now();
+
+    result.nsPerOpen     = std::chrono::duration<double, std::nano>(END - BEGIN).count() / RUNS;
+    result.allocsPerOpen = (double)(g_allocations - ALLOCSBEFORE) / RUNS;
+
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const int    WORKSPACES = argc > 1 ? std::atoi(argv[1]) : 100;
+    const SWorld WORLD      = makeWorld(WORKSPACES);
+    bool         mismatch   = !checkRecorded();
+
+    std::printf("%d workspaces, %d runs each\n", WORKSPACES, RUNS);
+    std::printf("%-7s %-5s %-6s %6s %6s %14s %14s %10s %10s %8s\n", "method", "skip", "scroll", "tiles", "used", "selectors ns", "snapshot ns", "sel alloc", "snap alloc", "speedup");
+
+    for (bool center : {true, false}) {
+        for (bool skipEmpty : {false, true}) {
+            // 0 is scroll_grid
+            for (size_t side : {3, 5, 10, 0}) {
+                const bool             SCROLL = side == 0;
+                const STileOrderParams PARAMS = {
+                    .center    = center,
+                    .startID   = center ? WORLD.active : 1,
+                    .tiles     = SCROLL ? 1000 : side * side,
+                    .skipEmpty = skipEmpty,
+                    .scroll    = SCROLL,
+                };
+
+                const auto SELECTORS = measure([&] { return orderTilesWithSelectors(WORLD, PARAMS); });
+                const auto SNAPSHOT  = measure([&] { return orderTilesWithSnapshot(WORLD, PARAMS); });
+
+                if (SELECTORS.ids != SNAPSHOT.ids) {
+                    std::fprintf(stderr, "mismatch: %s skip %d scroll %d tiles %zu\n", center ? "center" : "first", skipEmpty, SCROLL, PARAMS.tiles);
+                    mismatch = true;
+                }
+
+                std::printf("%-7s %-5d %-6d %6zu %6zu %14.0f %14.0f %10.1f %10.1f %7.1fx\n", center ? "center" : "first", skipEmpty, SCROLL, PARAMS.tiles, SNAPSHOT.ids.size(),
+                            SELECTORS.nsPerOpen, SNAPSHOT.nsPerOpen, SELECTORS.allocsPerOpen, SNAPSHOT.allocsPerOpen, SELECTORS.nsPerOpen / SNAPSHOT.nsPerOpen);
+            }
+        }
+    }
+
+    return mismatch ? 1 : 0;
+}
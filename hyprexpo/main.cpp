@@ -15,15 +15,22 @@ using namespace Hyprutils::String;
 
 #include "globals.hpp"
 #include "overview.hpp"
+#include "ThumbnailCache.hpp"
+#include "TileAtlas.hpp"
+#include "TileScheduler.hpp"
 #include "ExpoGesture.hpp"
 
 // Methods
 inline CFunctionHook* g_pRenderWorkspaceHook = nullptr;
 inline CFunctionHook* g_pAddDamageHookA      = nullptr;
 inline CFunctionHook* g_pAddDamageHookB      = nullptr;
+inline CFunctionHook* g_pDamageSurfaceHook   = nullptr;
+inline CFunctionHook* g_pDamageWindowHook    = nullptr;
 typedef void (*origRenderWorkspace)(void*, PHLMONITOR, PHLWORKSPACE, timespec*, const CBox&);
 typedef void (*origAddDamageA)(void*, const CBox&);
 typedef void (*origAddDamageB)(void*, const pixman_region32_t*);
+typedef void (*origDamageSurface)(void*, SP<CWLSurfaceResource>, double, double, double);
+typedef void (*origDamageWindow)(void*, PHLWINDOW, bool);
 
 static bool g_unloading = false;
 
@@ -32,73 +39,117 @@ APICALL EXPORT std::string PLUGIN_API_VERSION() {
     return HYPRLAND_API_VERSION;
 }
 
-static bool renderingOverview = false;
+// set while damage of a window goes through, that damage is reported per workspace instead
+static bool attributingDamage = false;
 
 //
 static void hkRenderWorkspace(void* thisptr, PHLMONITOR pMonitor, PHLWORKSPACE pWorkspace, timespec* now, const CBox& geometry) {
-    if (!g_pOverview || renderingOverview || g_pOverview->blockOverviewRendering || g_pOverview->pMonitor != pMonitor)
+    const auto POVERVIEW = pMonitor ? overviewFor(pMonitor->m_id) : nullptr;
+
+    if (!POVERVIEW || g_renderingOverview || POVERVIEW->blockOverviewRendering)
         ((origRenderWorkspace)(g_pRenderWorkspaceHook->m_original))(thisptr, pMonitor, pWorkspace, now, geometry);
     else
-        g_pOverview->render();
+        POVERVIEW->render();
 }
 
 static void hkAddDamageA(void* thisptr, const CBox& box) {
-    const auto PMONITOR = (CMonitor*)thisptr;
+    const auto PMONITOR  = (CMonitor*)thisptr;
+    const auto POVERVIEW = overviewFor(PMONITOR->m_id);
 
-    if (!g_pOverview || g_pOverview->pMonitor != PMONITOR->m_self || g_pOverview->blockDamageReporting) {
+    if (!POVERVIEW || POVERVIEW->blockDamageReporting) {
         ((origAddDamageA)g_pAddDamageHookA->m_original)(thisptr, box);
         return;
     }
 
-    g_pOverview->onDamageReported();
+    if (!attributingDamage)
+        POVERVIEW->onDamageReported();
 }
 
 static void hkAddDamageB(void* thisptr, const pixman_region32_t* rg) {
-    const auto PMONITOR = (CMonitor*)thisptr;
+    const auto PMONITOR  = (CMonitor*)thisptr;
+    const auto POVERVIEW = overviewFor(PMONITOR->m_id);
 
-    if (!g_pOverview || g_pOverview->pMonitor != PMONITOR->m_self || g_pOverview->blockDamageReporting) {
+    if (!POVERVIEW || POVERVIEW->blockDamageReporting) {
         ((origAddDamageB)g_pAddDamageHookB->m_original)(thisptr, rg);
         return;
     }
 
-    g_pOverview->onDamageReported();
+    if (!attributingDamage)
+        POVERVIEW->onDamageReported();
+}
+
+// whether anyone cares which workspace damage is for
+static bool trackingDamage() {
+    return !g_pOverviews.empty() || (g_pThumbnailCache && !g_pThumbnailCache->empty());
+}
+
+static void reportWindowDamage(PHLWINDOW pWindow) {
+    if (!pWindow || !pWindow->m_workspace)
+        return;
+
+    // rendering the tiles themselves damages windows, that's not new content
+    if (g_renderingOverview || std::ranges::any_of(g_pOverviews, [](const auto& pair) { return pair.second->blockOverviewRendering; }))
+        return;
+
+    // cached thumbnails go stale even while the overview is closed
+    if (g_pThumbnailCache)
+        g_pThumbnailCache->onWorkspaceDamaged(pWindow->workspaceID());
+
+    // every overview showing the workspace, it may be in the grid of several monitors
+    for (const auto& [id, overview] : g_pOverviews) {
+        overview->onWorkspaceDamaged(pWindow->workspaceID());
+    }
+}
+
+static void hkDamageSurface(void* thisptr, SP<CWLSurfaceResource> pSurface, double x, double y, double scale) {
+    const auto HLSURFACE = trackingDamage() && pSurface ? CWLSurface::fromResource(pSurface) : nullptr;
+    const auto PWINDOW   = HLSURFACE ? HLSURFACE->getWindow() : nullptr;
+
+    attributingDamage = PWINDOW != nullptr;
+    ((origDamageSurface)g_pDamageSurfaceHook->m_original)(thisptr, pSurface, x, y, scale);
+    attributingDamage = false;
+
+    reportWindowDamage(PWINDOW);
+}
+
+static void hkDamageWindow(void* thisptr, PHLWINDOW pWindow, bool forceFull) {
+    attributingDamage = trackingDamage() && pWindow;
+    ((origDamageWindow)g_pDamageWindowHook->m_original)(thisptr, pWindow, forceFull);
+    attributingDamage = false;
+
+    reportWindowDamage(pWindow);
 }
 
 static SDispatchResult onExpoDispatcher(std::string arg) {
 
-    if (g_pOverview && g_pOverview->m_isSwiping)
+    if (std::ranges::any_of(g_pOverviews, [](const auto& pair) { return pair.second->m_isSwiping; }))
         return {.success = false, .error = "already swiping"};
 
     if (arg == "select") {
-        if (g_pOverview) {
-            g_pOverview->selectHoveredWorkspace();
-            g_pOverview->close();
-        }
+        // only the one under the cursor selects, the others zoom back into what they show
+        forEachOverview([](COverview& overview) {
+            overview.selectHoveredWorkspace();
+            overview.close();
+        });
         return {};
     }
     if (arg == "toggle") {
-        if (g_pOverview)
-            g_pOverview->close();
-        else {
-            renderingOverview = true;
-            g_pOverview       = std::make_unique<COverview>(g_pCompositor->m_lastMonitor->m_activeWorkspace);
-            renderingOverview = false;
-        }
+        if (!g_pOverviews.empty())
+            forEachOverview([](COverview& overview) { overview.close(); });
+        else
+            openOverviews();
         return {};
     }
 
     if (arg == "off" || arg == "close" || arg == "disable") {
-        if (g_pOverview)
-            g_pOverview->close();
+        forEachOverview([](COverview& overview) { overview.close(); });
         return {};
     }
 
-    if (g_pOverview)
+    if (!g_pOverviews.empty())
         return {};
 
-    renderingOverview = true;
-    g_pOverview       = std::make_unique<COverview>(g_pCompositor->m_lastMonitor->m_activeWorkspace);
-    renderingOverview = false;
+    openOverviews();
     return {};
 }
 
@@ -213,9 +264,35 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
 
     g_pAddDamageHookA = HyprlandAPI::createFunctionHook(PHANDLE, FNS[0].address, (void*)hkAddDamageA);
 
+    // window damage, so we know which workspace it's for
+    FNS = HyprlandAPI::findFunctionsByName(PHANDLE, "damageSurface");
+    for (auto& fn : FNS) {
+        if (!fn.demangled.contains("CHyprRenderer::damageSurface"))
+            continue;
+
+        g_pDamageSurfaceHook = HyprlandAPI::createFunctionHook(PHANDLE, fn.address, (void*)hkDamageSurface);
+        break;
+    }
+
+    FNS = HyprlandAPI::findFunctionsByName(PHANDLE, "damageWindow");
+    for (auto& fn : FNS) {
+        if (!fn.demangled.contains("CHyprRenderer::damageWindow"))
+            continue;
+
+        g_pDamageWindowHook = HyprlandAPI::createFunctionHook(PHANDLE, fn.address, (void*)hkDamageWindow);
+        break;
+    }
+
+    if (!g_pDamageSurfaceHook || !g_pDamageWindowHook) {
+        failNotif("no fns for hook damageSurface / damageWindow");
+        throw std::runtime_error("[he] No fns for hook damageSurface / damageWindow");
+    }
+
     bool success = g_pRenderWorkspaceHook->hook();
     success      = success && g_pAddDamageHookA->hook();
     success      = success && g_pAddDamageHookB->hook();
+    success      = success && g_pDamageSurfaceHook->hook();
+    success      = success && g_pDamageWindowHook->hook();
 
     if (!success) {
         failNotif("Failed initializing hooks");
@@ -223,11 +300,24 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     }
 
     static auto P = HyprlandAPI::registerCallbackDynamic(PHANDLE, "preRender", [](void* self, SCallbackInfo& info, std::any param) {
-        if (!g_pOverview)
+        if (!g_pTileScheduler)
+            return;
+        g_pTileScheduler->onPreRender();
+    });
+
+    static auto P2 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "destroyWorkspace", [](void* self, SCallbackInfo& info, std::any param) {
+        if (!g_pThumbnailCache)
             return;
-        g_pOverview->onPreRender();
+        g_pThumbnailCache->onWorkspaceDestroyed(std::any_cast<CWorkspace*>(param)->m_id);
     });
 
+    static auto P3 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "monitorRemoved", [](void* self, SCallbackInfo& info, std::any param) {
+        g_pOverviews.erase(std::any_cast<PHLMONITOR>(param)->m_id);
+    });
+
+    g_pThumbnailCache = makeUnique<CThumbnailCache>();
+    g_pTileScheduler  = makeUnique<CTileScheduler>();
+
     HyprlandAPI::addDispatcherV2(PHANDLE, "hyprexpo:expo", ::onExpoDispatcher);
 
     HyprlandAPI::addConfigKeyword(PHANDLE, "hyprexpo-gesture", ::expoGestureKeyword, {});
@@ -237,6 +327,17 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:bg_col", Hyprlang::INT{0xFF111111});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:workspace_method", Hyprlang::STRING{"center current"});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:skip_empty", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:lowres_tiles", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:redraw_budget", Hyprlang::INT{4});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:progressive_open", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:placeholder_col", Hyprlang::INT{0xFF222222});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:cache_budget", Hyprlang::INT{256});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:batch_tiles", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:all_monitors", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:snapshot_current", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:mipmaps", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:debug_timing", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:scroll_grid", Hyprlang::INT{0});
 
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprexpo:gesture_distance", Hyprlang::INT{200});
 
@@ -250,5 +351,10 @@ APICALL EXPORT void PLUGIN_EXIT() {
 
     g_unloading = true;
 
+    g_pOverviews.clear();
+    g_pTileScheduler.reset();
+    g_pThumbnailCache.reset();
+    CTileAtlas::destroyShader();
+
     g_pConfigManager->reload(); // we need to reload now to clear all the gestures
 }
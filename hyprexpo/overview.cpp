@@ -1,5 +1,7 @@
 #include "overview.hpp"
+#include <algorithm>
 #include <any>
+#include <chrono>
 #define private public
 #include <hyprland/src/render/Renderer.hpp>
 #include <hyprland/src/Compositor.hpp>
@@ -9,37 +11,92 @@
 #include <hyprland/src/managers/animation/DesktopAnimationManager.hpp>
 #include <hyprland/src/managers/input/InputManager.hpp>
 #include <hyprland/src/helpers/time/Time.hpp>
+#include <hyprland/src/devices/IPointer.hpp>
 #undef private
 #include "OverviewPassElement.hpp"
+#include "TileScheduler.hpp"
+#include "WorkspaceOrder.hpp"
 
-static void damageMonitor(WP<Hyprutils::Animation::CBaseAnimatedVariable> thisptr) {
-    g_pOverview->damage();
+// a scroll_grid overview stops enumerating workspaces here
+constexpr size_t MAX_SCROLL_TILES = 1000;
+
+// rows off screen that keep their thumbnail with scroll_grid, so scrolling by one doesn't show placeholders
+constexpr int    PREFETCH_ROWS = 1;
+
+void openOverviews(bool swipe) {
+    static auto* const* PALLMONITORS = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:all_monitors")->getDataStaticPtr();
+
+    std::vector<PHLMONITOR> monitors;
+    if (**PALLMONITORS) {
+        for (const auto& m : g_pCompositor->m_monitors) {
+            if (m->m_enabled && m->m_activeWorkspace)
+                monitors.push_back(m);
+        }
+    } else
+        monitors.push_back(g_pCompositor->m_lastMonitor.lock());
+
+    // the constructor renders every tile once
+    g_renderingOverview = true;
+    for (const auto& m : monitors) {
+        if (!g_pOverviews.contains(m->m_id))
+            g_pOverviews[m->m_id] = std::make_unique<COverview>(m, m->m_activeWorkspace, swipe);
+    }
+    g_renderingOverview = false;
+}
+
+COverview* overviewFor(MONITORID id) {
+    const auto IT = g_pOverviews.find(id);
+    return IT == g_pOverviews.end() ? nullptr : IT->second.get();
 }
 
-static void removeOverview(WP<Hyprutils::Animation::CBaseAnimatedVariable> thisptr) {
-    g_pOverview.reset();
+void forEachOverview(const std::function<void(COverview&)>& fn) {
+    std::vector<MONITORID> ids;
+    for (const auto& [id, overview] : g_pOverviews) {
+        ids.push_back(id);
+    }
+
+    for (const auto ID : ids) {
+        if (const auto POVERVIEW = overviewFor(ID))
+            fn(*POVERVIEW);
+    }
 }
 
 COverview::~COverview() {
+    g_pTileScheduler->forget(this);
     g_pHyprRenderer->makeEGLCurrent();
     images.clear(); // otherwise we get a vram leak
+    atlas.reset();
+    compositionTimer.reset();
+
+    // our thumbnails are unused now, so they count for eviction
+    g_pThumbnailCache->evict();
     g_pInputManager->unsetCursorImage();
     g_pHyprOpenGL->markBlurDirtyForMonitor(pMonitor.lock());
 }
 
-COverview::COverview(PHLWORKSPACE startedOn_, bool swipe_) : startedOn(startedOn_), swipe(swipe_) {
-    const auto PMONITOR = g_pCompositor->m_lastMonitor.lock();
-    pMonitor            = PMONITOR;
-
-    static auto* const* PCOLUMNS = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:columns")->getDataStaticPtr();
-    static auto* const* PGAPS    = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:gap_size")->getDataStaticPtr();
-    static auto* const* PCOL     = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:bg_col")->getDataStaticPtr();
-    static auto* const* PSKIP    = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:skip_empty")->getDataStaticPtr();
-    static auto const*  PMETHOD  = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:workspace_method")->getDataStaticPtr();
-
-    SIDE_LENGTH = **PCOLUMNS;
-    GAP_WIDTH   = **PGAPS;
-    BG_COLOR    = **PCOL;
+COverview::COverview(PHLMONITOR pMonitor_, PHLWORKSPACE startedOn_, bool swipe_) : pMonitor(pMonitor_), startedOn(startedOn_), swipe(swipe_) {
+
+    static auto* const* PCOLUMNS     = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:columns")->getDataStaticPtr();
+    static auto* const* PGAPS        = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:gap_size")->getDataStaticPtr();
+    static auto* const* PCOL         = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:bg_col")->getDataStaticPtr();
+    static auto* const* PSKIP        = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:skip_empty")->getDataStaticPtr();
+    static auto* const* PLOWRES      = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:lowres_tiles")->getDataStaticPtr();
+    static auto* const* PPROGRESSIVE = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:progressive_open")->getDataStaticPtr();
+    static auto* const* PPLACEHOLDER = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:placeholder_col")->getDataStaticPtr();
+    static auto* const* PBATCH       = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:batch_tiles")->getDataStaticPtr();
+    static auto* const* PSNAPSHOT    = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:snapshot_current")->getDataStaticPtr();
+    static auto* const* PMIPMAPS     = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:mipmaps")->getDataStaticPtr();
+    static auto* const* PTIMING      = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:debug_timing")->getDataStaticPtr();
+    static auto* const* PSCROLL      = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:scroll_grid")->getDataStaticPtr();
+    static auto const*  PMETHOD      = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprexpo:workspace_method")->getDataStaticPtr();
+
+    SIDE_LENGTH       = **PCOLUMNS;
+    GAP_WIDTH         = **PGAPS;
+    BG_COLOR          = **PCOL;
+    LOWRES            = **PLOWRES;
+    MIPMAPS           = **PMIPMAPS;
+    SCROLL            = **PSCROLL;
+    PLACEHOLDER_COLOR = **PPLACEHOLDER;
 
     // process the method
     bool     methodCenter  = true;
@@ -54,159 +111,149 @@ COverview::COverview(PHLWORKSPACE startedOn_, bool swipe_) : startedOn(startedOn
             methodStartID = pMonitor->activeWorkspaceID();
     }
 
-    images.resize(SIDE_LENGTH * SIDE_LENGTH);
-
-    // r includes empty workspaces; m skips over them
-    std::string selector = **PSKIP ? "m" : "r";
-
-    if (methodCenter) {
-        int currentID = methodStartID;
-        int firstID   = currentID;
-
-        int backtracked = 0;
-
-        // Initialize tiles to WORKSPACE_INVALID; cliking one of these results
-        // in changing to "emptynm" (next empty workspace). Tiles with this id
-        // will only remain if skip_empty is on.
-        for (size_t i = 0; i < images.size(); i++) {
-            images[i].workspaceID = WORKSPACE_INVALID;
-        }
+    // one snapshot of the workspaces, instead of an "r+N" or "m+N" selector per tile that rescans them all each time
+    std::vector<WORKSPACEID> existing, unavailable;
+    for (const auto& w : g_pCompositor->getWorkspaces()) {
+        if (!w->m_isSpecialWorkspace && w->m_monitor == pMonitor)
+            existing.push_back(w->m_id);
+        else
+            unavailable.push_back(w->m_id);
+    }
 
-        // Scan through workspaces lower than methodStartID until we wrap; count how many
-        for (size_t i = 1; i < images.size() / 2; ++i) {
-            currentID = getWorkspaceIDNameFromString(selector + "-" + std::to_string(i)).id;
-            if (currentID >= firstID)
-                break;
+    for (const auto& rule : g_pConfigManager->getAllWorkspaceRules()) {
+        const auto PRULEMONITOR = g_pCompositor->getMonitorFromString(rule.monitor);
+        if (PRULEMONITOR && PRULEMONITOR != pMonitor)
+            unavailable.push_back(rule.workspaceId);
+    }
 
-            backtracked++;
-            firstID = currentID;
-        }
+    // center is relative to the active workspace like the selectors were, first to the start one
+    const CWorkspaceOrder ORDER{methodCenter ? pMonitor->activeWorkspaceID() : methodStartID, std::move(existing), std::move(unavailable)};
 
-        // Scan through workspaces higher than methodStartID. If using "m"
-        // (skip_empty), stop when we wrap, leaving the rest of the workspace
-        // ID's set to WORKSPACE_INVALID
-        for (size_t i = 0; i < (size_t)(SIDE_LENGTH * SIDE_LENGTH); ++i) {
-            auto& image = images[i];
-            if ((int64_t)i - backtracked < 0) {
-                currentID = getWorkspaceIDNameFromString(selector + std::to_string((int64_t)i - backtracked)).id;
-            } else {
-                currentID = getWorkspaceIDNameFromString(selector + "+" + std::to_string((int64_t)i - backtracked)).id;
-                if (i > 0 && currentID <= firstID)
-                    break;
-            }
-            image.workspaceID = currentID;
-        }
+    // r includes empty workspaces; m skips over them. Tiles past the last workspace stay WORKSPACE_INVALID,
+    // cliking one of these results in changing to "emptynm" (next empty workspace).
+    const size_t TILES = SCROLL ? MAX_SCROLL_TILES : SIDE_LENGTH * SIDE_LENGTH;
+    const auto   IDS   = orderTiles(ORDER, {.center = methodCenter, .startID = methodStartID, .tiles = TILES, .skipEmpty = **PSKIP != 0, .scroll = SCROLL});
 
-    } else {
-        int currentID         = methodStartID;
-        images[0].workspaceID = currentID;
-
-        auto PWORKSPACESTART = g_pCompositor->getWorkspaceByID(currentID);
-        if (!PWORKSPACESTART)
-            PWORKSPACESTART = CWorkspace::create(currentID, pMonitor.lock(), std::to_string(currentID));
-
-        pMonitor->m_activeWorkspace = PWORKSPACESTART;
-
-        // Scan through workspaces higher than methodStartID. If using "m"
-        // (skip_empty), stop when we wrap, leaving the rest of the workspace
-        // ID's set to WORKSPACE_INVALID
-        for (size_t i = 1; i < (size_t)(SIDE_LENGTH * SIDE_LENGTH); ++i) {
-            auto& image = images[i];
-            currentID   = getWorkspaceIDNameFromString(selector + "+" + std::to_string(i)).id;
-            if (currentID <= methodStartID)
-                break;
-            image.workspaceID = currentID;
-        }
+    // a fixed grid keeps its WORKSPACE_INVALID tiles, a scrolling one has no use for them
+    images.resize(SCROLL ? std::max<size_t>(IDS.size(), 1) : TILES);
 
-        pMonitor->m_activeWorkspace = startedOn;
+    for (size_t i = 0; i < IDS.size(); ++i) {
+        images[i].workspaceID = IDS[i];
     }
 
     g_pHyprRenderer->makeEGLCurrent();
 
     Vector2D tileSize       = pMonitor->m_size / SIDE_LENGTH;
     Vector2D tileRenderSize = (pMonitor->m_size - Vector2D{GAP_WIDTH * pMonitor->m_scale, GAP_WIDTH * pMonitor->m_scale} * (SIDE_LENGTH - 1)) / SIDE_LENGTH;
-    CBox     monbox{0, 0, tileSize.x * 2, tileSize.y * 2};
 
-    if (!ENABLE_LOWRES)
-        monbox = {{0, 0}, pMonitor->m_pixelSize};
+    int      currentid = 0;
 
-    int          currentid = 0;
+    for (size_t i = 0; i < images.size(); ++i) {
+        COverview::SWorkspaceImage& image = images[i];
 
-    PHLWORKSPACE openSpecial = PMONITOR->m_activeSpecialWorkspace;
-    if (openSpecial)
-        PMONITOR->m_activeSpecialWorkspace.reset();
+        image.pWorkspace = g_pCompositor->getWorkspaceByID(image.workspaceID);
+        image.box        = {(i % SIDE_LENGTH) * tileRenderSize.x + (i % SIDE_LENGTH) * GAP_WIDTH, (i / SIDE_LENGTH) * tileRenderSize.y + (i / SIDE_LENGTH) * GAP_WIDTH,
+                            tileRenderSize.x, tileRenderSize.y};
 
-    g_pHyprRenderer->m_bBlockSurfaceFeedback = true;
+        if (image.pWorkspace && image.pWorkspace == startedOn)
+            currentid = i;
+    }
 
-    startedOn->m_visible = false;
+    // start with the current tile's row as centered as it gets
+    firstRow = std::clamp(currentid / SIDE_LENGTH - SIDE_LENGTH / 2, 0, std::max(0, rows() - SIDE_LENGTH));
 
-    for (size_t i = 0; i < (size_t)(SIDE_LENGTH * SIDE_LENGTH); ++i) {
-        COverview::SWorkspaceImage& image = images[i];
-        image.fb.alloc(monbox.w, monbox.h, PMONITOR->m_output->state->state().drmFormat);
+    // tiles whose workspace wasn't damaged since we last rendered them are reused as they are.
+    // The current one is always rendered, we zoom out of it so it has to match the screen.
+    std::vector<int> stale;
+    for (int i = 0; i < (int)images.size(); ++i) {
+        auto& image = images[i];
 
-        CRegion fakeDamage{0, 0, INT16_MAX, INT16_MAX};
-        g_pHyprRenderer->beginRender(PMONITOR, fakeDamage, RENDER_MODE_FULL_FAKE, nullptr, &image.fb);
+        if (!isTileLive(i))
+            continue;
 
-        g_pHyprOpenGL->clear(CHyprColor{0, 0, 0, 1.0});
+        image.thumbnail = g_pThumbnailCache->get(image.workspaceID, pMonitor->m_id);
 
-        const auto PWORKSPACE = g_pCompositor->getWorkspaceByID(image.workspaceID);
+        if (i == currentid || !g_pThumbnailCache->isCurrent(*image.thumbnail, tileFramebufferBox(false).size()))
+            stale.push_back(i);
+    }
 
-        if (PWORKSPACE == startedOn)
-            currentid = i;
+    if (**PBATCH) {
+        atlas = makeUnique<CTileAtlas>(SIDE_LENGTH, tileFramebufferBox(false).size(), pMonitor->m_output->state->state().drmFormat, PLACEHOLDER_COLOR);
 
-        if (PWORKSPACE) {
-            image.pWorkspace            = PWORKSPACE;
-            PMONITOR->m_activeWorkspace = PWORKSPACE;
-            g_pDesktopAnimationManager->startAnimation(PWORKSPACE, CDesktopAnimationManager::ANIMATION_TYPE_IN, true, true);
-            PWORKSPACE->m_visible = true;
+        if (!atlas->good())
+            atlas.reset();
+        else
+            refillAtlas();
+    }
 
-            if (PWORKSPACE == startedOn)
-                PMONITOR->m_activeSpecialWorkspace = openSpecial;
+    if (**PTIMING) {
+        compositionTimer = makeUnique<CGPUTimer>(std::format("composition on {} (batch_tiles {}, mipmaps {}, lowres_tiles {})", pMonitor->m_name, atlas != nullptr, MIPMAPS, LOWRES));
 
-            g_pHyprRenderer->renderWorkspace(PMONITOR, PWORKSPACE, Time::steadyNow(), monbox);
+        if (!compositionTimer->good())
+            compositionTimer.reset();
+    }
 
-            PWORKSPACE->m_visible = false;
-            g_pDesktopAnimationManager->startAnimation(PWORKSPACE, CDesktopAnimationManager::ANIMATION_TYPE_OUT, false, true);
+    g_pHyprRenderer->m_bBlockSurfaceFeedback = true;
 
-            if (PWORKSPACE == startedOn)
-                PMONITOR->m_activeSpecialWorkspace.reset();
-        } else
-            g_pHyprRenderer->renderWorkspace(PMONITOR, PWORKSPACE, Time::steadyNow(), monbox);
+    // the snapshot copies the last frame out of the monitor's offload fb, which rendering any tile overwrites, so it goes first
+    const bool SNAPSHOTTED = **PSNAPSHOT && std::ranges::find(stale, currentid) != stale.end() && snapshotTile(images[currentid], true);
 
-        image.box = {(i % SIDE_LENGTH) * tileRenderSize.x + (i % SIDE_LENGTH) * GAP_WIDTH, (i / SIDE_LENGTH) * tileRenderSize.y + (i / SIDE_LENGTH) * GAP_WIDTH, tileRenderSize.x,
-                     tileRenderSize.y};
+    // we start zoomed in on the current tile, so that one needs full res.
+    // When opening progressively, it's the only one we render before the first frame.
+    for (const int ID : stale) {
+        if (ID == currentid && SNAPSHOTTED)
+            continue;
 
-        g_pHyprOpenGL->m_renderData.blockScreenShader = true;
-        g_pHyprRenderer->endRender();
+        if (!**PPROGRESSIVE || ID == currentid)
+            renderTile(images[ID], ID == currentid);
     }
 
     g_pHyprRenderer->m_bBlockSurfaceFeedback = false;
 
-    PMONITOR->m_activeSpecialWorkspace = openSpecial;
-    PMONITOR->m_activeWorkspace        = startedOn;
-    startedOn->m_visible               = true;
-    g_pDesktopAnimationManager->startAnimation(startedOn, CDesktopAnimationManager::ANIMATION_TYPE_IN, true, true);
-
     // zoom on the current workspace.
     // const auto& TILE = images[std::clamp(currentid, 0, SIDE_LENGTH * SIDE_LENGTH)];
 
     g_pAnimationManager->createAnimation(pMonitor->m_size * pMonitor->m_size / tileSize, size, g_pConfigManager->getAnimationPropertyConfig("windowsMove"), AVARDAMAGE_NONE);
-    g_pAnimationManager->createAnimation((-((pMonitor->m_size / (double)SIDE_LENGTH) * Vector2D{currentid % SIDE_LENGTH, currentid / SIDE_LENGTH}) * pMonitor->m_scale) *
-                                             (pMonitor->m_size / tileSize),
-                                         pos, g_pConfigManager->getAnimationPropertyConfig("windowsMove"), AVARDAMAGE_NONE);
+    g_pAnimationManager->createAnimation((-((pMonitor->m_size / (double)SIDE_LENGTH) * cellOf(currentid)) * pMonitor->m_scale) * (pMonitor->m_size / tileSize), pos,
+                                         g_pConfigManager->getAnimationPropertyConfig("windowsMove"), AVARDAMAGE_NONE);
 
-    size->setUpdateCallback(damageMonitor);
-    pos->setUpdateCallback(damageMonitor);
+    size->setUpdateCallback([this](auto) { damage(); });
+    pos->setUpdateCallback([this](auto) { damage(); });
 
     if (!swipe) {
         *size = pMonitor->m_size;
         *pos  = {0, 0};
 
-        size->setCallbackOnEnd([this](auto) { redrawAll(true); });
+        // back down to low res now that we're not zoomed in anymore
+        size->setCallbackOnEnd([this](auto) {
+            if (LOWRES)
+                markDirty(openedID);
+        });
     }
 
     openedID = currentid;
 
+    if (**PPROGRESSIVE) {
+        // the others get filled in over the next frames, nearest to the current one first
+        std::vector<int> pending;
+        for (const int ID : stale) {
+            if (ID != currentid)
+                pending.push_back(ID);
+        }
+
+        const auto DISTANCE = [this, currentid](int id) {
+            const int DX = id % SIDE_LENGTH - currentid % SIDE_LENGTH;
+            const int DY = id / SIDE_LENGTH - currentid / SIDE_LENGTH;
+            return DX * DX + DY * DY;
+        };
+
+        std::ranges::stable_sort(pending, {}, DISTANCE);
+
+        for (const int ID : pending) {
+            markDirty(ID);
+        }
+    }
+
     g_pInputManager->setCursorImageUntilUnset("left_ptr");
 
     lastMousePosLocal = g_pInputManager->getMouseCoordsInternal() - pMonitor->m_position;
@@ -235,16 +282,123 @@ COverview::COverview(PHLWORKSPACE startedOn_, bool swipe_) : startedOn(startedOn
 
     mouseButtonHook = g_pHookSystem->hookDynamic("mouseButton", onCursorSelect);
     touchDownHook   = g_pHookSystem->hookDynamic("touchDown", onCursorSelect);
+
+    if (!SCROLL)
+        return;
+
+    mouseAxisHook = g_pHookSystem->hookDynamic("mouseAxis", [this](void* self, SCallbackInfo& info, std::any param) {
+        // cells move while zooming, so only scroll at rest
+        if (closing || size->isBeingAnimated() || !CBox{pMonitor->m_position, pMonitor->m_size}.containsPoint(g_pInputManager->getMouseCoordsInternal()))
+            return;
+
+        info.cancelled = true;
+
+        auto       data = std::any_cast<std::unordered_map<std::string, std::any>>(param);
+        const auto E    = std::any_cast<IPointer::SAxisEvent>(data["event"]);
+
+        if (E.axis != WL_POINTER_AXIS_VERTICAL_SCROLL)
+            return;
+
+        // a wheel notch is 15, touchpads send many small steps
+        scrollAccumulator += E.delta;
+        while (std::abs(scrollAccumulator) >= 15) {
+            const int STEP = scrollAccumulator > 0 ? 1 : -1;
+            scrollAccumulator -= STEP * 15;
+            scrollBy(STEP);
+        }
+    });
 }
 
 void COverview::selectHoveredWorkspace() {
     if (closing)
         return;
 
+    // the cursor is on another monitor's overview
+    if (!CBox{pMonitor->m_position, pMonitor->m_size}.containsPoint(g_pInputManager->getMouseCoordsInternal()))
+        return;
+
     // get tile x,y
     int x     = lastMousePosLocal.x / pMonitor->m_size.x * SIDE_LENGTH;
     int y     = lastMousePosLocal.y / pMonitor->m_size.y * SIDE_LENGTH;
-    closeOnID = x + y * SIDE_LENGTH;
+    const int ID = x + (y + firstRow) * SIDE_LENGTH;
+
+    // past the last tile of a scrolling grid
+    if (ID >= (int)images.size())
+        return;
+
+    closeOnID = ID;
+}
+
+Vector2D COverview::cellOf(int id) {
+    return Vector2D{id % SIDE_LENGTH, id / SIDE_LENGTH - firstRow};
+}
+
+int COverview::rows() {
+    return (images.size() + SIDE_LENGTH - 1) / SIDE_LENGTH;
+}
+
+bool COverview::isTileLive(int id) {
+    const int ROW = id / SIDE_LENGTH;
+    return ROW >= firstRow - PREFETCH_ROWS && ROW < firstRow + SIDE_LENGTH + PREFETCH_ROWS;
+}
+
+void COverview::updateLiveTiles() {
+    for (int i = 0; i < (int)images.size(); ++i) {
+        auto& image = images[i];
+
+        if (!isTileLive(i)) {
+            // it stays in the cache until evicted, scrolling back is likely
+            image.thumbnail.reset();
+            continue;
+        }
+
+        if (image.thumbnail)
+            continue;
+
+        image.thumbnail = g_pThumbnailCache->get(image.workspaceID, pMonitor->m_id);
+
+        if (!g_pThumbnailCache->isCurrent(*image.thumbnail, tileFramebufferBox(false).size()))
+            markDirty(i);
+    }
+
+    g_pThumbnailCache->evict();
+}
+
+void COverview::scrollBy(int rows_) {
+    const int NEWROW = std::clamp(firstRow + rows_, 0, std::max(0, rows() - SIDE_LENGTH));
+
+    if (NEWROW == firstRow)
+        return;
+
+    firstRow = NEWROW;
+
+    g_pHyprRenderer->makeEGLCurrent();
+    updateLiveTiles();
+    refillAtlas();
+    damage();
+}
+
+void COverview::scrollTo(int id) {
+    const int ROW = id / SIDE_LENGTH;
+
+    if (ROW >= firstRow && ROW < firstRow + SIDE_LENGTH)
+        return;
+
+    scrollBy(ROW < firstRow ? ROW - firstRow : ROW - (firstRow + SIDE_LENGTH - 1));
+}
+
+void COverview::refillAtlas() {
+    if (!atlas)
+        return;
+
+    // the atlas only has slots for the tiles on screen
+    atlas->clear();
+
+    for (int i = firstRow * SIDE_LENGTH; i < std::min((int)images.size(), (firstRow + SIDE_LENGTH) * SIDE_LENGTH); ++i) {
+        // stale ones too, they're still better than a placeholder until they're redrawn
+        if (images[i].thumbnail && images[i].thumbnail->valid)
+            atlas->copy(i - firstRow * SIDE_LENGTH, images[i].thumbnail->levelFor(atlas->slotSize().x));
+    }
 }
 
 void COverview::redrawID(int id, bool forcelowres) {
@@ -257,27 +411,50 @@ void COverview::redrawID(int id, bool forcelowres) {
 
     g_pHyprRenderer->makeEGLCurrent();
 
-    id = std::clamp(id, 0, SIDE_LENGTH * SIDE_LENGTH);
+    id = std::clamp(id, 0, (int)images.size() - 1);
 
-    Vector2D tileSize       = pMonitor->m_size / SIDE_LENGTH;
-    Vector2D tileRenderSize = (pMonitor->m_size - Vector2D{GAP_WIDTH, GAP_WIDTH} * (SIDE_LENGTH - 1)) / SIDE_LENGTH;
-    CBox     monbox{0, 0, tileSize.x * 2, tileSize.y * 2};
+    // while zooming, the tile we zoom on is bigger than its on-screen size at rest
+    renderTile(images[id], !forcelowres && id == focusedID() && (size->value() != pMonitor->m_size || closing));
 
-    if (!forcelowres && (size->value() != pMonitor->m_size || closing))
-        monbox = {{0, 0}, pMonitor->m_pixelSize};
+    blockOverviewRendering = false;
+}
+
+CBox COverview::tileFramebufferBox(bool fullres) {
+    if (fullres || !LOWRES)
+        return {{0, 0}, pMonitor->m_pixelSize};
+
+    return {0, 0, std::ceil(pMonitor->m_pixelSize.x / SIDE_LENGTH), std::ceil(pMonitor->m_pixelSize.y / SIDE_LENGTH)};
+}
 
-    if (!ENABLE_LOWRES)
-        monbox = {{0, 0}, pMonitor->m_pixelSize};
+void COverview::renderTile(SWorkspaceImage& image, bool fullres) {
+    static auto PBLUR = CConfigValue<Hyprlang::INT>("decoration:blur:enabled");
 
-    auto& image = images[id];
+    const CBox monbox = tileFramebufferBox(fullres);
+    auto&      fb     = image.thumbnail->fb;
 
-    if (image.fb.m_size != monbox.size()) {
-        image.fb.release();
-        image.fb.alloc(monbox.w, monbox.h, pMonitor->m_output->state->state().drmFormat);
+    if (fb.m_size != monbox.size()) {
+        fb.release();
+        fb.alloc(monbox.w, monbox.h, pMonitor->m_output->state->state().drmFormat);
     }
 
+    // blur works on monitor-sized buffers and doesn't survive being rendered smaller,
+    // so with blur we render at full res and downscale into the tile afterwards.
+    const bool    VIASCRATCH = *PBLUR && monbox.size() != pMonitor->m_pixelSize;
+    const CBox    RENDERBOX  = VIASCRATCH ? CBox{{0, 0}, pMonitor->m_pixelSize} : monbox;
+    CFramebuffer* target     = &fb;
+
+    if (VIASCRATCH) {
+        if (scratchFB.m_size != pMonitor->m_pixelSize) {
+            scratchFB.release();
+            scratchFB.alloc(pMonitor->m_pixelSize.x, pMonitor->m_pixelSize.y, pMonitor->m_output->state->state().drmFormat);
+        }
+
+        target = &scratchFB;
+    } else if (scratchFB.isAllocated())
+        scratchFB.release();
+
     CRegion fakeDamage{0, 0, INT16_MAX, INT16_MAX};
-    g_pHyprRenderer->beginRender(pMonitor.lock(), fakeDamage, RENDER_MODE_FULL_FAKE, nullptr, &image.fb);
+    g_pHyprRenderer->beginRender(pMonitor.lock(), fakeDamage, RENDER_MODE_FULL_FAKE, nullptr, target);
 
     g_pHyprOpenGL->clear(CHyprColor{0, 0, 0, 1.0});
 
@@ -297,7 +474,7 @@ void COverview::redrawID(int id, bool forcelowres) {
         if (PWORKSPACE == startedOn)
             pMonitor->m_activeSpecialWorkspace = openSpecial;
 
-        g_pHyprRenderer->renderWorkspace(pMonitor.lock(), PWORKSPACE, Time::steadyNow(), monbox);
+        g_pHyprRenderer->renderWorkspace(pMonitor.lock(), PWORKSPACE, Time::steadyNow(), RENDERBOX);
 
         PWORKSPACE->m_visible = false;
         g_pDesktopAnimationManager->startAnimation(PWORKSPACE, CDesktopAnimationManager::ANIMATION_TYPE_OUT, false, true);
@@ -305,23 +482,112 @@ void COverview::redrawID(int id, bool forcelowres) {
         if (PWORKSPACE == startedOn)
             pMonitor->m_activeSpecialWorkspace.reset();
     } else
-        g_pHyprRenderer->renderWorkspace(pMonitor.lock(), PWORKSPACE, Time::steadyNow(), monbox);
+        g_pHyprRenderer->renderWorkspace(pMonitor.lock(), PWORKSPACE, Time::steadyNow(), RENDERBOX);
 
     g_pHyprOpenGL->m_renderData.blockScreenShader = true;
     g_pHyprRenderer->endRender();
 
+    if (VIASCRATCH) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, scratchFB.getFBID());
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fb.getFBID());
+        glBlitFramebuffer(0, 0, scratchFB.m_size.x, scratchFB.m_size.y, 0, 0, fb.m_size.x, fb.m_size.y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    downsampleTile(image);
+
+    if (atlas)
+        atlas->copy(&image - images.data() - firstRow * SIDE_LENGTH, image.thumbnail->levelFor(atlas->slotSize().x));
+
     pMonitor->m_activeSpecialWorkspace = openSpecial;
     pMonitor->m_activeWorkspace        = startedOn;
     startedOn->m_visible               = true;
     g_pDesktopAnimationManager->startAnimation(startedOn, CDesktopAnimationManager::ANIMATION_TYPE_IN, true, true);
 
-    blockOverviewRendering = false;
+    // last, so the damage from shuffling workspaces around above doesn't count as new content
+    g_pThumbnailCache->markRendered(*image.thumbnail);
 }
 
-void COverview::redrawAll(bool forcelowres) {
-    for (size_t i = 0; i < (size_t)(SIDE_LENGTH * SIDE_LENGTH); ++i) {
-        redrawID(i, forcelowres);
+bool COverview::snapshotTile(SWorkspaceImage& image, bool fullres) {
+    // the current workspace is what the monitor showed last frame, as long as nothing but us composited it.
+    // Only before our first frame though, after that the monitor shows the overview.
+    if (image.pWorkspace != startedOn || pMonitor->m_transform != WL_OUTPUT_TRANSFORM_NORMAL || !pMonitor->m_lastScanout.expired())
+        return false;
+
+    const auto RESOURCES = g_pHyprOpenGL->m_monitorRenderResources.find(pMonitor);
+    if (RESOURCES == g_pHyprOpenGL->m_monitorRenderResources.end())
+        return false;
+
+    auto& offloadFB = RESOURCES->second.offloadFB;
+    if (!offloadFB.isAllocated() || offloadFB.m_size != pMonitor->m_pixelSize)
+        return false;
+
+    const CBox monbox = tileFramebufferBox(fullres);
+    auto&      fb     = image.thumbnail->fb;
+
+    if (fb.m_size != monbox.size()) {
+        fb.release();
+        fb.alloc(monbox.w, monbox.h, pMonitor->m_output->state->state().drmFormat);
     }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, offloadFB.getFBID());
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fb.getFBID());
+    glBlitFramebuffer(0, 0, offloadFB.m_size.x, offloadFB.m_size.y, 0, 0, fb.m_size.x, fb.m_size.y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    downsampleTile(image);
+
+    if (atlas)
+        atlas->copy(&image - images.data() - firstRow * SIDE_LENGTH, image.thumbnail->levelFor(atlas->slotSize().x));
+
+    g_pThumbnailCache->markRendered(*image.thumbnail);
+
+    return true;
+}
+
+void COverview::downsampleTile(SWorkspaceImage& image) {
+    auto& thumbnail = *image.thumbnail;
+
+    if (!MIPMAPS) {
+        thumbnail.mips.clear();
+        return;
+    }
+
+    // halve until the next one would be smaller than the tile at rest, nothing is drawn smaller than that
+    const double  RESTWIDTH = std::ceil(pMonitor->m_pixelSize.x / SIDE_LENGTH);
+
+    CFramebuffer* previous = &thumbnail.fb;
+    size_t        levels   = 0;
+
+    while (std::ceil(previous->m_size.x / 2) >= RESTWIDTH) {
+        const Vector2D SIZE = {std::ceil(previous->m_size.x / 2), std::ceil(previous->m_size.y / 2)};
+
+        if (thumbnail.mips.size() <= levels)
+            thumbnail.mips.emplace_back(makeUnique<CFramebuffer>());
+
+        auto& mip = *thumbnail.mips[levels];
+
+        if (mip.m_size != SIZE) {
+            mip.release();
+            mip.alloc(SIZE.x, SIZE.y, pMonitor->m_output->state->state().drmFormat);
+        }
+
+        // halving with linear filtering averages each 2x2 block, which a single blit down to the rest size wouldn't
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, previous->getFBID());
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mip.getFBID());
+        glBlitFramebuffer(0, 0, previous->m_size.x, previous->m_size.y, 0, 0, mip.m_size.x, mip.m_size.y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+        previous = &mip;
+        levels++;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    thumbnail.mips.resize(levels);
+}
+
+int COverview::focusedID() {
+    return closing ? (closeOnID == -1 ? openedID : closeOnID) : openedID;
 }
 
 void COverview::damage() {
@@ -331,23 +597,44 @@ void COverview::damage() {
 }
 
 void COverview::onDamageReported() {
-    damageDirty = true;
+    // damage we can't attribute to a workspace, the tile on screen is the likely one
+    if (!blockOverviewRendering && openedID >= 0 && openedID < (int)images.size())
+        g_pThumbnailCache->onWorkspaceDamaged(images[openedID].workspaceID);
+
+    markDirty(openedID);
+}
+
+void COverview::onWorkspaceDamaged(WORKSPACEID id) {
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (images[i].workspaceID == id)
+            markDirty(i);
+    }
+}
+
+void COverview::markDirty(int id) {
+    // damage caused by rendering a tile is not new content, and tiles scrolled away have nothing to redraw
+    if (blockOverviewRendering || id < 0 || id >= (int)images.size() || images[id].dirty || !images[id].thumbnail)
+        return;
 
+    images[id].dirty = true;
+    g_pTileScheduler->queue(this, id);
+
+    damageTile(id);
+    g_pCompositor->scheduleFrameForMonitor(pMonitor.lock());
+}
+
+void COverview::damageTile(int id) {
     Vector2D SIZE = size->value();
 
-    Vector2D tileSize       = (SIZE / SIDE_LENGTH);
     Vector2D tileRenderSize = (SIZE - Vector2D{GAP_WIDTH, GAP_WIDTH} * (SIDE_LENGTH - 1)) / SIDE_LENGTH;
-    // const auto& TILE           = images[std::clamp(openedID, 0, SIDE_LENGTH * SIDE_LENGTH)];
-    CBox texbox = CBox{(openedID % SIDE_LENGTH) * tileRenderSize.x + (openedID % SIDE_LENGTH) * GAP_WIDTH,
-                       (openedID / SIDE_LENGTH) * tileRenderSize.y + (openedID / SIDE_LENGTH) * GAP_WIDTH, tileRenderSize.x, tileRenderSize.y}
-                      .translate(pMonitor->m_position);
 
-    damage();
+    const auto CELL   = cellOf(id);
+    CBox       texbox = CBox{CELL.x * tileRenderSize.x + CELL.x * GAP_WIDTH, CELL.y * tileRenderSize.y + CELL.y * GAP_WIDTH, tileRenderSize.x, tileRenderSize.y}.translate(
+        pMonitor->m_position);
 
     blockDamageReporting = true;
     g_pHyprRenderer->damageBox(texbox);
     blockDamageReporting = false;
-    g_pCompositor->scheduleFrameForMonitor(pMonitor.lock());
 }
 
 void COverview::close() {
@@ -356,18 +643,23 @@ void COverview::close() {
 
     const int   ID = closeOnID == -1 ? openedID : closeOnID;
 
-    const auto& TILE = images[std::clamp(ID, 0, SIDE_LENGTH * SIDE_LENGTH)];
+    const auto& TILE = images[std::clamp(ID, 0, (int)images.size() - 1)];
+
+    // we zoom into it, so it has to be on screen
+    scrollTo(ID);
 
-    Vector2D    tileSize = (pMonitor->m_size / SIDE_LENGTH);
+    Vector2D tileSize = (pMonitor->m_size / SIDE_LENGTH);
 
     *size = pMonitor->m_size * pMonitor->m_size / tileSize;
-    *pos  = (-((pMonitor->m_size / (double)SIDE_LENGTH) * Vector2D{ID % SIDE_LENGTH, ID / SIDE_LENGTH}) * pMonitor->m_scale) * (pMonitor->m_size / tileSize);
+    *pos  = (-((pMonitor->m_size / (double)SIDE_LENGTH) * cellOf(ID)) * pMonitor->m_scale) * (pMonitor->m_size / tileSize);
 
-    size->setCallbackOnEnd(removeOverview);
+    // erases this
+    size->setCallbackOnEnd([ID = pMonitor->m_id](auto) { g_pOverviews.erase(ID); });
 
     closing = true;
 
-    redrawAll();
+    // only the tile we zoom on is seen bigger than at rest
+    redrawID(ID);
 
     if (TILE.workspaceID != pMonitor->activeWorkspaceID()) {
         pMonitor->setSpecialWorkspace(0);
@@ -381,6 +673,9 @@ void COverview::close() {
 
         const auto OLDWS = pMonitor->m_activeWorkspace;
 
+        // changeworkspace works on the focused monitor, which may be another overview's
+        g_pCompositor->setActiveMonitor(pMonitor.lock());
+
         if (!NEWIDWS)
             g_pKeybindManager->changeworkspace(std::to_string(NEWID));
         else
@@ -393,11 +688,15 @@ void COverview::close() {
     }
 }
 
-void COverview::onPreRender() {
-    if (damageDirty) {
-        damageDirty = false;
-        redrawID(closing ? (closeOnID == -1 ? openedID : closeOnID) : openedID);
-    }
+void COverview::redrawDirty(int id) {
+    images[id].dirty = false;
+
+    // scrolled away since it was queued
+    if (!images[id].thumbnail)
+        return;
+
+    redrawID(id);
+    damageTile(id);
 }
 
 void COverview::onWorkspaceChange() {
@@ -406,7 +705,7 @@ void COverview::onWorkspaceChange() {
     else
         startedOn = pMonitor->m_activeWorkspace;
 
-    for (size_t i = 0; i < (size_t)(SIDE_LENGTH * SIDE_LENGTH); ++i) {
+    for (size_t i = 0; i < images.size(); ++i) {
         if (images[i].workspaceID != pMonitor->activeWorkspaceID())
             continue;
 
@@ -419,7 +718,7 @@ void COverview::onWorkspaceChange() {
 }
 
 void COverview::render() {
-    g_pHyprRenderer->m_renderPass.add(makeUnique<COverviewPassElement>());
+    g_pHyprRenderer->m_renderPass.add(makeUnique<COverviewPassElement>(this));
 }
 
 void COverview::fullRender() {
@@ -435,17 +734,45 @@ void COverview::fullRender() {
     Vector2D tileSize       = (SIZE / SIDE_LENGTH);
     Vector2D tileRenderSize = (SIZE - Vector2D{GAPSIZE, GAPSIZE} * (SIDE_LENGTH - 1)) / SIDE_LENGTH;
 
+    if (compositionTimer)
+        compositionTimer->begin();
+
     g_pHyprOpenGL->clear(BG_COLOR.stripA());
 
+    // one draw per damage rect for the whole grid
+    if (atlas)
+        atlas->draw(g_pHyprOpenGL->m_renderData.damage, pos->value(), tileRenderSize * pMonitor->m_scale, (tileRenderSize + Vector2D{GAPSIZE, GAPSIZE}) * pMonitor->m_scale,
+                    images.size() - firstRow * SIDE_LENGTH);
+
     for (size_t y = 0; y < (size_t)SIDE_LENGTH; ++y) {
         for (size_t x = 0; x < (size_t)SIDE_LENGTH; ++x) {
+            const size_t ID = x + (y + firstRow) * SIDE_LENGTH;
+
+            // the last rows of a scrolling grid
+            if (ID >= images.size() || !images[ID].thumbnail)
+                continue;
+
+            const auto& IMAGE = images[ID];
+
+            // the atlas has everything but the full-res tile we zoom on, that one is drawn on top to stay sharp
+            if (atlas && (!IMAGE.thumbnail->valid || IMAGE.thumbnail->fb.m_size == atlas->slotSize()))
+                continue;
+
             CBox texbox = {x * tileRenderSize.x + x * GAPSIZE, y * tileRenderSize.y + y * GAPSIZE, tileRenderSize.x, tileRenderSize.y};
             texbox.scale(pMonitor->m_scale).translate(pos->value());
             texbox.round();
-            CRegion damage{0, 0, INT16_MAX, INT16_MAX};
-            g_pHyprOpenGL->renderTextureInternal(images[x + y * SIDE_LENGTH].fb.getTexture(), texbox, {.damage = &damage, .a = 1.0});
+            CRegion damage = atlas ? g_pHyprOpenGL->m_renderData.damage.copy() : CRegion{0, 0, INT16_MAX, INT16_MAX};
+
+            // a stale thumbnail from last time still beats a placeholder
+            if (!IMAGE.thumbnail->valid)
+                g_pHyprOpenGL->renderRect(texbox, PLACEHOLDER_COLOR, {.damage = &damage});
+            else
+                g_pHyprOpenGL->renderTextureInternal(IMAGE.thumbnail->levelFor(texbox.w).getTexture(), texbox, {.damage = &damage, .a = 1.0});
         }
     }
+
+    if (compositionTimer)
+        compositionTimer->end();
 }
 
 static float lerp(const float& from, const float& to, const float perc) {
@@ -478,8 +805,7 @@ void COverview::onSwipeUpdate(double delta) {
     Vector2D            tileSize = (pMonitor->m_size / SIDE_LENGTH);
 
     const auto          SIZEMAX = pMonitor->m_size * pMonitor->m_size / tileSize;
-    const auto          POSMAX  = (-((pMonitor->m_size / (double)SIDE_LENGTH) * Vector2D{WORKSPACE_FOCUS_ID % SIDE_LENGTH, WORKSPACE_FOCUS_ID / SIDE_LENGTH}) * pMonitor->m_scale) *
-        (pMonitor->m_size / tileSize);
+    const auto          POSMAX  = (-((pMonitor->m_size / (double)SIDE_LENGTH) * cellOf(WORKSPACE_FOCUS_ID)) * pMonitor->m_scale) * (pMonitor->m_size / tileSize);
 
     const auto SIZEMIN = pMonitor->m_size;
     const auto POSMIN  = Vector2D{0, 0};
@@ -499,7 +825,10 @@ void COverview::onSwipeEnd() {
     *size = pMonitor->m_size;
     *pos  = {0, 0};
 
-    size->setCallbackOnEnd([this](WP<Hyprutils::Animation::CBaseAnimatedVariable> thisptr) { redrawAll(true); });
+    size->setCallbackOnEnd([this](WP<Hyprutils::Animation::CBaseAnimatedVariable> thisptr) {
+        if (LOWRES)
+            markDirty(openedID);
+    });
 
     swipeWasCommenced = true;
     m_isSwiping       = false;
@@ -3,27 +3,31 @@
 #define WLR_USE_UNSTABLE
 
 #include "globals.hpp"
+#include "ThumbnailCache.hpp"
+#include "TileAtlas.hpp"
+#include "GPUTimer.hpp"
 #include <hyprland/src/desktop/DesktopTypes.hpp>
 #include <hyprland/src/render/Framebuffer.hpp>
 #include <hyprland/src/helpers/AnimatedVariable.hpp>
 #include <hyprland/src/managers/HookSystemManager.hpp>
+#include <functional>
+#include <unordered_map>
 #include <vector>
 
-// saves on resources, but is a bit broken rn with blur.
-// hyprland's fault, but cba to fix.
-constexpr bool ENABLE_LOWRES = false;
-
 class CMonitor;
 
 class COverview {
   public:
-    COverview(PHLWORKSPACE startedOn_, bool swipe = false);
+    COverview(PHLMONITOR pMonitor_, PHLWORKSPACE startedOn_, bool swipe = false);
     ~COverview();
 
     void render();
     void damage();
     void onDamageReported();
-    void onPreRender();
+    void onWorkspaceDamaged(WORKSPACEID id);
+
+    // from g_pTileScheduler, redraws a tile queued with markDirty
+    void redrawDirty(int id);
 
     void setClosing(bool closing);
 
@@ -42,23 +46,51 @@ class COverview {
     bool          m_isSwiping = false;
 
   private:
+    struct SWorkspaceImage {
+        SP<SThumbnail> thumbnail; // from g_pThumbnailCache, may be left over from a previous overview
+        int64_t        workspaceID = -1;
+        PHLWORKSPACE   pWorkspace;
+        CBox           box;
+        bool           dirty = false;
+    };
+
     void       redrawID(int id, bool forcelowres = false);
-    void       redrawAll(bool forcelowres = false);
+    void       markDirty(int id);
+    void       damageTile(int id);
+    int        focusedID();
+    void       renderTile(SWorkspaceImage& image, bool fullres);
+    bool       snapshotTile(SWorkspaceImage& image, bool fullres);
+    void       downsampleTile(SWorkspaceImage& image);
+    CBox       tileFramebufferBox(bool fullres);
     void       onWorkspaceChange();
     void       fullRender();
 
+    // on-screen column and row of a tile, the row counts from firstRow
+    Vector2D   cellOf(int id);
+    int        rows();
+
+    // with scroll_grid, only tiles on screen or a row away hold a thumbnail
+    bool       isTileLive(int id);
+    void       updateLiveTiles();
+    void       scrollBy(int rows);
+    void       scrollTo(int id);
+    void       refillAtlas();
+
     int        SIDE_LENGTH = 3;
     int        GAP_WIDTH   = 5;
     CHyprColor BG_COLOR    = CHyprColor{0.1, 0.1, 0.1, 1.0};
 
-    bool       damageDirty = false;
+    // drawn for tiles that haven't been rendered yet
+    CHyprColor PLACEHOLDER_COLOR = CHyprColor{0.15, 0.15, 0.15, 1.0};
 
-    struct SWorkspaceImage {
-        CFramebuffer fb;
-        int64_t      workspaceID = -1;
-        PHLWORKSPACE pWorkspace;
-        CBox         box;
-    };
+    // tiles are rendered at their on-screen size, except the one we zoom on
+    bool       LOWRES = false;
+
+    // tiles get box-filtered half-size copies, down to their size at rest
+    bool       MIPMAPS = false;
+
+    // SIDE_LENGTH is only the column count, there are as many rows as workspaces need and SIDE_LENGTH of them fit on screen
+    bool       SCROLL = false;
 
     Vector2D                     lastMousePosLocal = Vector2D{};
 
@@ -67,6 +99,19 @@ class COverview {
 
     std::vector<SWorkspaceImage> images;
 
+    // topmost row on screen, always 0 without scroll_grid
+    int                          firstRow          = 0;
+    double                       scrollAccumulator = 0;
+
+    // low-res tiles with blur are rendered here at full res first, see renderTile
+    CFramebuffer                 scratchFB;
+
+    // with plugin:hyprexpo:batch_tiles, null if the GPU couldn't take it
+    UP<CTileAtlas>               atlas;
+
+    // times fullRender with plugin:hyprexpo:debug_timing
+    UP<CGPUTimer>                compositionTimer;
+
     PHLWORKSPACE                 startedOn;
 
     PHLANIMVAR<Vector2D>         size;
@@ -78,6 +123,7 @@ class COverview {
     SP<HOOK_CALLBACK_FN>         mouseButtonHook;
     SP<HOOK_CALLBACK_FN>         touchMoveHook;
     SP<HOOK_CALLBACK_FN>         touchDownHook;
+    SP<HOOK_CALLBACK_FN>         mouseAxisHook;
 
     bool                         swipe             = false;
     bool                         swipeWasCommenced = false;
@@ -85,4 +131,16 @@ class COverview {
     friend class COverviewPassElement;
 };
 
-inline std::unique_ptr<COverview> g_pOverview;
+// one per monitor it's open on
+inline std::unordered_map<MONITORID, std::unique_ptr<COverview>> g_pOverviews;
+
+// set while overviews render their tiles, the workspace hook passes through and the damage isn't new content
+inline bool g_renderingOverview = false;
+
+// on every monitor with plugin:hyprexpo:all_monitors, otherwise on the focused one
+void       openOverviews(bool swipe = false);
+
+COverview* overviewFor(MONITORID id);
+
+// safe against fn closing an overview for good
+void       forEachOverview(const std::function<void(COverview&)>& fn);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+
+// plugin:hyprexpo:batch_tiles. One instance per tile, 4 vertices each, the grid is laid out from uniforms.
+// Positions are in monitor px, the atlas holds tile n at column n % sideLength, row n / sideLength.
+inline const std::string TILEGRID = R"#(
+#version 300 es
+precision highp float;
+uniform mat3 proj;
+uniform int sideLength;
+uniform vec2 monitorSize;
+uniform vec2 origin;
+uniform vec2 tileSize;
+uniform vec2 stride;
+uniform vec2 atlasTexel;
+out vec2 v_texcoord;
+flat out vec4 v_slot;
+
+void main() {
+    vec2 corner = vec2(gl_VertexID % 2, gl_VertexID / 2);
+    vec2 cell   = vec2(gl_InstanceID % sideLength, gl_InstanceID / sideLength);
+
+    // rounded like the boxes of the per-tile path
+    vec2 pos = floor(origin + cell * stride + corner * tileSize + 0.5);
+    gl_Position = vec4(proj * vec3(pos / monitorSize, 1.0), 1.0);
+
+    // keep linear filtering from bleeding in the neighbors
+    float side = float(sideLength);
+    v_texcoord = (cell + corner) / side;
+    v_slot     = vec4(cell / side + atlasTexel * 0.5, (cell + 1.0) / side - atlasTexel * 0.5);
+})#";
+
+inline const std::string FRAGTILEGRID = R"#(
+#version 300 es
+precision highp float;
+uniform sampler2D tex;
+in vec2 v_texcoord;
+flat in vec4 v_slot;
+
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+    fragColor = vec4(texture(tex, clamp(v_texcoord, v_slot.xy, v_slot.zw)).rgb, 1.0);
+})#";
@@ -1,6 +1,7 @@
 #include "Scrolling.hpp"
 
 #include <algorithm>
+#include <utility>
 
 #include <hyprland/src/Compositor.hpp>
 #include <hyprland/src/managers/input/InputManager.hpp>
@@ -25,7 +26,10 @@ void SColumnData::add(PHLWINDOW w) {
         wd->windowSize *= (float)windowDatas.size() / (float)(windowDatas.size() + 1);
     }
 
-    windowDatas.emplace_back(makeShared<SScrollingWindowData>(w, self.lock(), 1.F / (float)(windowDatas.size() + 1)));
+    const auto DATA = windowDatas.emplace_back(makeShared<SScrollingWindowData>(w, self.lock(), 1.F / (float)(windowDatas.size() + 1)));
+
+    if (workspace)
+        workspace->layout->indexWindow(DATA);
 }
 
 void SColumnData::add(PHLWINDOW w, int after) {
@@ -33,7 +37,10 @@ void SColumnData::add(PHLWINDOW w, int after) {
         wd->windowSize *= (float)windowDatas.size() / (float)(windowDatas.size() + 1);
     }
 
-    windowDatas.insert(windowDatas.begin() + after + 1, makeShared<SScrollingWindowData>(w, self.lock(), 1.F / (float)(windowDatas.size() + 1)));
+    const auto DATA = *windowDatas.insert(windowDatas.begin() + after + 1, makeShared<SScrollingWindowData>(w, self.lock(), 1.F / (float)(windowDatas.size() + 1)));
+
+    if (workspace)
+        workspace->layout->indexWindow(DATA);
 }
 
 void SColumnData::add(SP<SScrollingWindowData> w) {
@@ -44,6 +51,10 @@ void SColumnData::add(SP<SScrollingWindowData> w) {
     windowDatas.emplace_back(w);
     w->column     = self;
     w->windowSize = 1.F / (float)(windowDatas.size());
+    w->needsApply = true;
+
+    if (workspace)
+        workspace->layout->indexWindow(w);
 }
 
 void SColumnData::add(SP<SScrollingWindowData> w, int after) {
@@ -54,6 +65,10 @@ void SColumnData::add(SP<SScrollingWindowData> w, int after) {
     windowDatas.insert(windowDatas.begin() + after + 1, w);
     w->column     = self;
     w->windowSize = 1.F / (float)(windowDatas.size());
+    w->needsApply = true;
+
+    if (workspace)
+        workspace->layout->indexWindow(w);
 }
 
 size_t SColumnData::idx(PHLWINDOW w) {
@@ -80,6 +95,9 @@ void SColumnData::remove(PHLWINDOW w) {
     if (SIZE_BEFORE == windowDatas.size() && SIZE_BEFORE > 0)
         return;
 
+    if (workspace)
+        workspace->layout->unindexWindow(w);
+
     float newMaxSize = 0.F;
     for (auto& wd : windowDatas) {
         newMaxSize += wd->windowSize;
@@ -144,6 +162,7 @@ SP<SColumnData> SWorkspaceData::add() {
     auto              col       = columns.emplace_back(makeShared<SColumnData>(self.lock()));
     col->self                   = col;
     col->columnWidth            = *PCOLWIDTH;
+    invalidateOffsets();
     return col;
 }
 
@@ -153,10 +172,17 @@ SP<SColumnData> SWorkspaceData::add(int after) {
     col->self                   = col;
     col->columnWidth            = *PCOLWIDTH;
     columns.insert(columns.begin() + after + 1, col);
+    invalidateOffsets();
     return col;
 }
 
 int64_t SWorkspaceData::idx(SP<SColumnData> c) {
+    columnOffsets();
+
+    if (c && c->cachedIdx < columns.size() && columns[c->cachedIdx] == c)
+        return c->cachedIdx;
+
+    // columns changed without an invalidateOffsets()
     for (size_t i = 0; i < columns.size(); ++i) {
         if (columns[i] == c)
             return i;
@@ -167,78 +193,82 @@ int64_t SWorkspaceData::idx(SP<SColumnData> c) {
 
 void SWorkspaceData::remove(SP<SColumnData> c) {
     std::erase(columns, c);
+    invalidateOffsets();
 }
 
 SP<SColumnData> SWorkspaceData::next(SP<SColumnData> c) {
-    for (size_t i = 0; i < columns.size(); ++i) {
-        if (columns[i] != c)
-            continue;
+    const auto IDX = idx(c);
 
-        if (i == columns.size() - 1)
-            return nullptr;
-
-        return columns[i + 1];
-    }
+    if (IDX == -1 || IDX == (int64_t)columns.size() - 1)
+        return nullptr;
 
-    return nullptr;
+    return columns[IDX + 1];
 }
 
 SP<SColumnData> SWorkspaceData::prev(SP<SColumnData> c) {
-    for (size_t i = 0; i < columns.size(); ++i) {
-        if (columns[i] != c)
-            continue;
-
-        if (i == 0)
-            return nullptr;
+    const auto IDX = idx(c);
 
-        return columns[i - 1];
-    }
+    if (IDX <= 0)
+        return nullptr;
 
-    return nullptr;
+    return columns[IDX - 1];
 }
 
-void SWorkspaceData::centerCol(SP<SColumnData> c) {
-    if (!c)
-        return;
-
+const std::vector<double>& SWorkspaceData::columnOffsets() {
     static const auto PFSONONE = CConfigValue<Hyprlang::INT>("plugin:hyprscrolling:fullscreen_on_one_column");
 
-    PHLMONITOR        PMONITOR    = workspace->m_monitor.lock();
-    double            currentLeft = 0;
-    const auto        USABLE      = layout->usableAreaFor(PMONITOR);
+    // idx() still needs cachedIdx without a monitor, e.g. while a window is removed from a workspace that lost it
+    const auto        PMONITOR = workspace ? workspace->m_monitor.lock() : nullptr;
+    const double      USABLEW  = PMONITOR ? layout->usableAreaFor(PMONITOR).w : 0;
 
-    for (const auto& COL : columns) {
-        const double ITEM_WIDTH = *PFSONONE && columns.size() == 1 ? USABLE.w : USABLE.w * COL->columnWidth;
+    // the monitor, its reserved area or the config may have changed since, which nobody tells us about
+    if (offsetsValid && offsets.size() == columns.size() + 1 && offsetsUsableWidth == USABLEW && offsetsFSOnOne == !!*PFSONONE)
+        return offsets;
 
-        if (COL != c)
-            currentLeft += ITEM_WIDTH;
-        else {
-            leftOffset = currentLeft - (USABLE.w - ITEM_WIDTH) / 2.F;
-            return;
-        }
+    offsets.resize(columns.size() + 1);
+
+    double currentLeft = 0;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        columns[i]->cachedIdx = i;
+        offsets[i]            = currentLeft;
+        currentLeft += *PFSONONE && columns.size() == 1 ? USABLEW : USABLEW * columns[i]->columnWidth;
     }
+
+    offsets.back() = currentLeft;
+
+    offsetsValid       = true;
+    offsetsUsableWidth = USABLEW;
+    offsetsFSOnOne     = *PFSONONE;
+
+    return offsets;
 }
 
-void SWorkspaceData::fitCol(SP<SColumnData> c) {
-    if (!c)
+void SWorkspaceData::invalidateOffsets() {
+    offsetsValid = false;
+}
+
+void SWorkspaceData::centerCol(SP<SColumnData> c) {
+    const auto IDX = idx(c);
+    if (IDX == -1)
         return;
 
-    static const auto PFSONONE = CConfigValue<Hyprlang::INT>("plugin:hyprscrolling:fullscreen_on_one_column");
+    const auto& OFFSETS    = columnOffsets();
+    const auto  USABLE     = layout->usableAreaFor(workspace->m_monitor.lock());
+    const auto  ITEM_WIDTH = OFFSETS[IDX + 1] - OFFSETS[IDX];
 
-    PHLMONITOR        PMONITOR    = workspace->m_monitor.lock();
-    double            currentLeft = 0;
-    const auto        USABLE      = layout->usableAreaFor(PMONITOR);
+    leftOffset = OFFSETS[IDX] - (USABLE.w - ITEM_WIDTH) / 2.F;
+}
 
-    for (const auto& COL : columns) {
-        const double ITEM_WIDTH = *PFSONONE && columns.size() == 1 ? USABLE.w : USABLE.w * COL->columnWidth;
+void SWorkspaceData::fitCol(SP<SColumnData> c) {
+    const auto IDX = idx(c);
+    if (IDX == -1)
+        return;
 
-        if (COL != c)
-            currentLeft += ITEM_WIDTH;
-        else {
-            leftOffset = std::clamp((double)leftOffset, currentLeft - USABLE.w + ITEM_WIDTH, currentLeft);
-            return;
-        }
-    }
+    const auto& OFFSETS    = columnOffsets();
+    const auto  USABLE     = layout->usableAreaFor(workspace->m_monitor.lock());
+    const auto  ITEM_WIDTH = OFFSETS[IDX + 1] - OFFSETS[IDX];
+
+    leftOffset = std::clamp((double)leftOffset, OFFSETS[IDX] - USABLE.w + ITEM_WIDTH, OFFSETS[IDX]);
 }
 
 void SWorkspaceData::centerOrFitCol(SP<SColumnData> c) {
@@ -254,25 +284,60 @@ void SWorkspaceData::centerOrFitCol(SP<SColumnData> c) {
 }
 
 SP<SColumnData> SWorkspaceData::atCenter() {
-    static const auto PFSONONE = CConfigValue<Hyprlang::INT>("plugin:hyprscrolling:fullscreen_on_one_column");
+    const auto& OFFSETS  = columnOffsets();
+    PHLMONITOR  PMONITOR = workspace->m_monitor.lock();
 
-    PHLMONITOR        PMONITOR    = workspace->m_monitor.lock();
-    double            currentLeft = leftOffset;
-    const auto        USABLE      = layout->usableAreaFor(PMONITOR);
+    // the first column whose right edge is past the middle
+    const auto IT = std::lower_bound(OFFSETS.begin() + 1, OFFSETS.end(), PMONITOR->m_size.x / 2.0 - 2 - leftOffset);
 
-    for (const auto& COL : columns) {
-        const double ITEM_WIDTH = *PFSONONE && columns.size() == 1 ? USABLE.w : USABLE.w * COL->columnWidth;
+    if (IT == OFFSETS.end())
+        return nullptr;
 
-        currentLeft += ITEM_WIDTH;
+    return columns[IT - OFFSETS.begin() - 1];
+}
 
-        if (currentLeft >= PMONITOR->m_size.x / 2.0 - 2)
-            return COL;
+void SWorkspaceData::recalculate(bool forceInstant) {
+    if (forceInstant) {
+        recalculatePending = false;
+        layoutWindows(true);
+        return;
     }
 
-    return nullptr;
+    if (recalculatePending)
+        return;
+
+    recalculatePending = true;
+    layout->m_pendingRecalculations.emplace_back(self);
+
+    if (workspace && workspace->m_monitor)
+        g_pCompositor->scheduleFrameForMonitor(workspace->m_monitor.lock());
 }
 
-void SWorkspaceData::recalculate(bool forceInstant) {
+void SWorkspaceData::flushRecalculate() {
+    if (!recalculatePending)
+        return;
+
+    recalculatePending = false;
+    layoutWindows(false);
+}
+
+void SWorkspaceData::recalculateWindowNow(SP<SScrollingWindowData> w) {
+    if (!w)
+        return;
+
+    layoutWindows(false, w);
+}
+
+static bool sameGaps(const CCssGapData& a, const CCssGapData& b) {
+    return a.m_top == b.m_top && a.m_right == b.m_right && a.m_bottom == b.m_bottom && a.m_left == b.m_left;
+}
+
+// everything applyNodeDataToWindow reads beyond a window's own box
+static bool sameLayoutContext(const SLayoutContext& a, const SLayoutContext& b) {
+    return a.area == b.area && sameGaps(a.gapsIn, b.gapsIn) && sameGaps(a.gapsOut, b.gapsOut) && a.specialScaleFactor == b.specialScaleFactor;
+}
+
+void SWorkspaceData::layoutWindows(bool forceInstant, SP<SScrollingWindowData> only) {
     static const auto PFSONONE = CConfigValue<Hyprlang::INT>("plugin:hyprscrolling:fullscreen_on_one_column");
 
     if (!workspace || !workspace) {
@@ -284,15 +349,31 @@ void SWorkspaceData::recalculate(bool forceInstant) {
 
     PHLMONITOR   PMONITOR = workspace->m_monitor.lock();
 
-    const CBox   USABLE = layout->usableAreaFor(PMONITOR);
+    // rules like w[tv1] depend on the windows, so the gaps may change whenever we lay out
+    const auto   CTX    = layout->layoutContextFor(workspace.lock());
+    const CBox   USABLE = CTX.usable;
+
+    // a window whose box stayed put still needs its new gaps
+    if (!sameLayoutContext(CTX, lastLayoutCtx))
+        invalidateWindows();
+
+    lastLayoutCtx = CTX;
 
     double       currentLeft = 0;
     const double cameraLeft  = MAX_WIDTH < USABLE.w ? std::round((MAX_WIDTH - USABLE.w) / 2.0) : leftOffset; // layout pixels
 
+    // windows further than a screen past either edge stay where they were last put until they come closer,
+    // nobody sees them there. Scrolling a long strip then only touches the windows around the view.
+    const double VIEWLEFT  = PMONITOR->m_position.x + PMONITOR->m_reservedTopLeft.x - USABLE.w;
+    const double VIEWRIGHT = PMONITOR->m_position.x + PMONITOR->m_reservedTopLeft.x + USABLE.w * 2;
+    const auto   NEARVIEW  = [VIEWLEFT, VIEWRIGHT](const CBox& box) { return box.x < VIEWRIGHT && box.x + box.w > VIEWLEFT; };
+
     for (size_t i = 0; i < columns.size(); ++i) {
         const auto&  COL        = columns[i];
         double       currentTop = 0.0;
         const double ITEM_WIDTH = *PFSONONE && columns.size() == 1 ? USABLE.w : USABLE.w * COL->columnWidth;
+        const bool   HASRIGHT   = i != columns.size() - 1;
+        const bool   HASLEFT    = i != 0;
 
         for (const auto& WINDOW : COL->windowDatas) {
             WINDOW->layoutBox =
@@ -300,81 +381,78 @@ void SWorkspaceData::recalculate(bool forceInstant) {
 
             currentTop += WINDOW->windowSize * USABLE.h;
 
-            layout->applyNodeDataToWindow(WINDOW, forceInstant, i != columns.size() - 1, i != 0);
-        }
+            if (only && WINDOW != only)
+                continue;
 
-        currentLeft += ITEM_WIDTH;
-        if (currentLeft == USABLE.width)
-            currentLeft++; // avoid ffm from "grabbing" the window on the right
-    }
-}
+            const bool CHANGED = WINDOW->layoutBox != WINDOW->appliedBox || HASRIGHT != WINDOW->appliedHasRight || HASLEFT != WINDOW->appliedHasLeft;
 
-double SWorkspaceData::maxWidth() {
-    static const auto PFSONONE = CConfigValue<Hyprlang::INT>("plugin:hyprscrolling:fullscreen_on_one_column");
+            // the old box counts too, a window leaving the view has to be moved out of it
+            if (!only && !forceInstant && !WINDOW->needsApply && (!CHANGED || (!NEARVIEW(WINDOW->layoutBox) && !NEARVIEW(WINDOW->appliedBox))))
+                continue;
 
-    PHLMONITOR        PMONITOR    = workspace->m_monitor.lock();
-    double            currentLeft = 0;
-    const auto        USABLE      = layout->usableAreaFor(PMONITOR);
+            WINDOW->appliedBox      = WINDOW->layoutBox;
+            WINDOW->appliedHasRight = HASRIGHT;
+            WINDOW->appliedHasLeft  = HASLEFT;
+            WINDOW->needsApply      = false;
 
-    for (const auto& COL : columns) {
-        const double ITEM_WIDTH = *PFSONONE && columns.size() == 1 ? USABLE.w : USABLE.w * COL->columnWidth;
+            layout->applyNodeDataToWindow(WINDOW, CTX, forceInstant, HASRIGHT, HASLEFT);
+        }
 
         currentLeft += ITEM_WIDTH;
+        if (currentLeft == USABLE.width)
+            currentLeft++; // avoid ffm from "grabbing" the window on the right
     }
 
-    return currentLeft;
+    static const auto PCHECKINDEXES = CConfigValue<Hyprlang::INT>("plugin:hyprscrolling:debug_check_indexes");
+
+    if (!only && *PCHECKINDEXES)
+        layout->checkIndexes();
 }
 
-bool SWorkspaceData::visible(SP<SColumnData> c) {
-    const auto USABLE    = layout->usableAreaFor(workspace->m_monitor.lock());
-    float      totalLeft = 0;
+void SWorkspaceData::invalidateWindows() {
     for (const auto& col : columns) {
-        if (col == c) {
-            const float colLeft   = totalLeft;
-            const float colRight  = totalLeft + col->columnWidth * USABLE.w;
-            const float viewLeft  = leftOffset;
-            const float viewRight = leftOffset + USABLE.w;
-            return colLeft < viewRight && viewLeft < colRight;
+        for (const auto& wd : col->windowDatas) {
+            wd->needsApply = true;
         }
-
-        totalLeft += col->columnWidth * USABLE.w;
     }
-
-    return false;
 }
 
-void CScrollingLayout::applyNodeDataToWindow(SP<SScrollingWindowData> data, bool force, bool hasWindowsRight, bool hasWindowsLeft) {
-    PHLMONITOR   PMONITOR;
-    PHLWORKSPACE PWORKSPACE;
+double SWorkspaceData::maxWidth() {
+    return columnOffsets().back();
+}
 
-    if (!data || !data->column || !data->column->workspace) {
-        if (!data->overrideWorkspace) {
-            Debug::log(ERR, "[scroller] broken internal state on workspace (1)");
-            return;
-        }
+bool SWorkspaceData::visible(SP<SColumnData> c) {
+    const auto IDX = idx(c);
+    if (IDX == -1)
+        return false;
+
+    const auto& OFFSETS   = columnOffsets();
+    const auto  USABLE    = layout->usableAreaFor(workspace->m_monitor.lock());
+    const float colLeft   = OFFSETS[IDX];
+    const float colRight  = OFFSETS[IDX + 1];
+    const float viewLeft  = leftOffset;
+    const float viewRight = leftOffset + USABLE.w;
+    return colLeft < viewRight && viewLeft < colRight;
+}
 
-        PMONITOR   = data->overrideWorkspace->m_monitor.lock();
-        PWORKSPACE = data->overrideWorkspace.lock();
-    } else {
-        PMONITOR   = data->column->workspace->workspace->m_monitor.lock();
-        PWORKSPACE = data->column->workspace->workspace.lock();
+void CScrollingLayout::applyNodeDataToWindow(SP<SScrollingWindowData> data, const SLayoutContext& ctx, bool force, bool hasWindowsRight, bool hasWindowsLeft) {
+    if (!data) {
+        Debug::log(ERR, "[scroller] broken internal state on workspace (1)");
+        return;
     }
 
-    if (!PMONITOR || !PWORKSPACE) {
+    if (!ctx.monitor || !ctx.workspace) {
         Debug::log(ERR, "[scroller] broken internal state on workspace (2)");
         return;
     }
 
     // for gaps outer
-    const bool DISPLAYLEFT   = !hasWindowsLeft && STICKS(data->layoutBox.x, PMONITOR->m_position.x + PMONITOR->m_reservedTopLeft.x);
-    const bool DISPLAYRIGHT  = !hasWindowsRight && STICKS(data->layoutBox.x + data->layoutBox.w, PMONITOR->m_position.x + PMONITOR->m_size.x - PMONITOR->m_reservedBottomRight.x);
-    const bool DISPLAYTOP    = STICKS(data->layoutBox.y, PMONITOR->m_position.y + PMONITOR->m_reservedTopLeft.y);
-    const bool DISPLAYBOTTOM = STICKS(data->layoutBox.y + data->layoutBox.h, PMONITOR->m_position.y + PMONITOR->m_size.y - PMONITOR->m_reservedBottomRight.y);
+    const bool DISPLAYLEFT   = !hasWindowsLeft && STICKS(data->layoutBox.x, ctx.area.x);
+    const bool DISPLAYRIGHT  = !hasWindowsRight && STICKS(data->layoutBox.x + data->layoutBox.w, ctx.area.x + ctx.area.w);
+    const bool DISPLAYTOP    = STICKS(data->layoutBox.y, ctx.area.y);
+    const bool DISPLAYBOTTOM = STICKS(data->layoutBox.y + data->layoutBox.h, ctx.area.y + ctx.area.h);
 
     const auto PWINDOW = data->window.lock();
-    // get specific gaps and rules for this workspace,
-    // if user specified them in config
-    const auto WORKSPACERULE = g_pConfigManager->getWorkspaceRuleFor(PWORKSPACE);
 
     if (!validMapped(PWINDOW)) {
         Debug::log(ERR, "Node {} holding invalid {}!!", (uintptr_t)data.get(), PWINDOW);
@@ -388,13 +466,8 @@ void CScrollingLayout::applyNodeDataToWindow(SP<SScrollingWindowData> data, bool
     PWINDOW->unsetWindowData(PRIORITY_LAYOUT);
     PWINDOW->updateWindowData();
 
-    static auto PGAPSINDATA  = CConfigValue<Hyprlang::CUSTOMTYPE>("general:gaps_in");
-    static auto PGAPSOUTDATA = CConfigValue<Hyprlang::CUSTOMTYPE>("general:gaps_out");
-    auto* const PGAPSIN      = (CCssGapData*)(PGAPSINDATA.ptr())->getData();
-    auto* const PGAPSOUT     = (CCssGapData*)(PGAPSOUTDATA.ptr())->getData();
-
-    auto        gapsIn  = WORKSPACERULE.gapsIn.value_or(*PGAPSIN);
-    auto        gapsOut = WORKSPACERULE.gapsOut.value_or(*PGAPSOUT);
+    const auto& gapsIn  = ctx.gapsIn;
+    const auto& gapsOut = ctx.gapsOut;
     CBox        nodeBox = data->layoutBox;
     nodeBox.round();
 
@@ -443,9 +516,7 @@ void CScrollingLayout::applyNodeDataToWindow(SP<SScrollingWindowData> data, bool
 
     if (PWINDOW->onSpecialWorkspace() && !PWINDOW->isFullscreen()) {
         // if special, we adjust the coords a bit
-        static auto PSCALEFACTOR = CConfigValue<Hyprlang::FLOAT>("dwindle:special_scale_factor");
-
-        CBox        wb = {calcPos + (calcSize - calcSize * *PSCALEFACTOR) / 2.f, calcSize * *PSCALEFACTOR};
+        CBox wb = {calcPos + (calcSize - calcSize * ctx.specialScaleFactor) / 2.f, calcSize * ctx.specialScaleFactor};
         wb.round(); // avoid rounding mess
 
         *PWINDOW->m_realPosition = wb.pos();
@@ -474,6 +545,11 @@ void CScrollingLayout::onEnable() {
     static const auto PCONFWIDTHS = CConfigValue<Hyprlang::STRING>("plugin:hyprscrolling:explicit_column_widths");
 
     m_configCallback = g_pHookSystem->hookDynamic("configReloaded", [this](void* hk, SCallbackInfo& info, std::any param) {
+        // gaps and rules may be different now
+        for (const auto& ws : m_workspaceDatas) {
+            ws->invalidateWindows();
+        }
+
         // bitch ass
         m_config.configuredWidths.clear();
 
@@ -509,6 +585,18 @@ void CScrollingLayout::onEnable() {
         DATA->recalculate();
     });
 
+    // one layout pass per workspace per frame, however many times it was recalculated since the last one
+    m_preRenderCallback = g_pHookSystem->hookDynamic("preRender", [this](void* hk, SCallbackInfo& info, std::any param) {
+        if (m_pendingRecalculations.empty())
+            return;
+
+        const auto PENDING = std::exchange(m_pendingRecalculations, {});
+        for (const auto& ws : PENDING) {
+            if (const auto WS = ws.lock())
+                WS->flushRecalculate();
+        }
+    });
+
     for (auto const& w : g_pCompositor->m_windows) {
         if (w->m_isFloating || !w->m_isMapped || w->isHidden())
             continue;
@@ -519,7 +607,11 @@ void CScrollingLayout::onEnable() {
 
 void CScrollingLayout::onDisable() {
     m_workspaceDatas.clear();
+    m_windowIndex.clear();
+    m_workspaceIndex.clear();
+    m_pendingRecalculations.clear();
     m_configCallback.reset();
+    m_preRenderCallback.reset();
 }
 
 void CScrollingLayout::onWindowCreatedTiling(PHLWINDOW window, eDirection direction) {
@@ -530,8 +622,7 @@ void CScrollingLayout::onWindowCreatedTiling(PHLWINDOW window, eDirection direct
 
     if (!workspaceData) {
         Debug::log(LOG, "[scrolling] No workspace data yet, creating");
-        workspaceData       = m_workspaceDatas.emplace_back(makeShared<SWorkspaceData>(window->m_workspace, this));
-        workspaceData->self = workspaceData;
+        workspaceData = createWorkspaceData(window->m_workspace);
     }
 
     auto droppingOn = g_pCompositor->m_lastWindow.lock();
@@ -567,6 +658,9 @@ void CScrollingLayout::onWindowCreatedTiling(PHLWINDOW window, eDirection direct
     }
 
     workspaceData->recalculate();
+
+    // Hyprland sends the new window its size right after this, the windows making room for it can wait for the frame
+    workspaceData->recalculateWindowNow(dataFor(window));
 }
 
 void CScrollingLayout::onWindowRemovedTiling(PHLWINDOW window) {
@@ -585,13 +679,13 @@ void CScrollingLayout::onWindowRemovedTiling(PHLWINDOW window) {
 
     DATA->column->remove(window);
 
-    WS->recalculate();
-
     if (!DATA->column) {
         // column got removed, let's ensure we don't leave any cringe extra space
         const auto USABLE = usableAreaFor(window->m_monitor.lock());
         WS->leftOffset    = std::clamp((double)WS->leftOffset, 0.0, std::max(WS->maxWidth() - USABLE.w, 1.0));
     }
+
+    WS->recalculate();
 }
 
 bool CScrollingLayout::isWindowTiled(PHLWINDOW window) {
@@ -610,7 +704,12 @@ void CScrollingLayout::recalculateMonitor(const MONITORID& id) {
     if (!DATA)
         return;
 
+    // whatever changed on the monitor, it's not in the boxes
+    DATA->invalidateWindows();
     DATA->recalculate();
+
+    // Hyprland reads the result right away, e.g. when going fullscreen
+    DATA->flushRecalculate();
 }
 
 void CScrollingLayout::recalculateWindow(PHLWINDOW window) {
@@ -622,7 +721,16 @@ void CScrollingLayout::recalculateWindow(PHLWINDOW window) {
     if (!DATA)
         return;
 
-    DATA->recalculate();
+    const auto WDATA = dataFor(window);
+
+    if (!WDATA) {
+        DATA->recalculate();
+        return;
+    }
+
+    // pseudotiling, decorations and the like change without moving the box
+    WDATA->needsApply = true;
+    DATA->recalculateWindowNow(WDATA);
 }
 
 void CScrollingLayout::onBeginDragWindow() {
@@ -679,6 +787,8 @@ void CScrollingLayout::resizeActiveWindow(const Vector2D& delta, eRectCorner cor
         default: break;
     }
 
+    DATA->column->workspace->invalidateOffsets();
+
     if (DATA->column->windowDatas.size() > 1) {
         const auto CURR_WD = DATA;
         const auto NEXT_WD = DATA->column->next(DATA);
@@ -746,8 +856,8 @@ void CScrollingLayout::fullscreenRequestForWindow(PHLWINDOW pWindow, const eFull
     if (EFFECTIVE_MODE == FSMODE_NONE) {
         // if it got its fullscreen disabled, set back its node if it had one
 
-        if (PNODE)
-            applyNodeDataToWindow(PNODE, false, false, false);
+        if (PNODE && PNODE->column && PNODE->column->workspace)
+            applyNodeDataToWindow(PNODE, layoutContextFor(PNODE->column->workspace->workspace.lock()), false, false, false);
         else {
             // get back its' dimensions from position and size
             *pWindow->m_realPosition = pWindow->m_lastFloatingPosition;
@@ -773,7 +883,7 @@ void CScrollingLayout::fullscreenRequestForWindow(PHLWINDOW pWindow, const eFull
             fakeNode->ignoreFullscreenChecks = true;
             fakeNode->overrideWorkspace      = pWindow->m_workspace;
 
-            applyNodeDataToWindow(fakeNode, false, false, false);
+            applyNodeDataToWindow(fakeNode, layoutContextFor(pWindow->m_workspace), false, false, false);
         }
     }
 
@@ -837,6 +947,9 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
             DATA->recalculate();
 
             g_pCompositor->focusWindow(COL->windowDatas.front()->window.lock());
+
+            // warping reads the window's position, which only moves in the layout pass
+            DATA->flushRecalculate();
             g_pCompositor->warpCursorTo(COL->windowDatas.front()->window.lock()->middle());
 
             return {};
@@ -847,6 +960,7 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
                     DATA->centerCol(DATA->columns.back());
                     DATA->recalculate();
                     g_pCompositor->focusWindow((DATA->columns.back()->windowDatas.back())->window.lock());
+                    DATA->flushRecalculate();
                     g_pCompositor->warpCursorTo((DATA->columns.back()->windowDatas.back())->window.lock()->middle());
                 }
 
@@ -861,6 +975,7 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
             DATA->recalculate();
 
             g_pCompositor->focusWindow(COL->windowDatas.back()->window.lock());
+            DATA->flushRecalculate();
             g_pCompositor->warpCursorTo(COL->windowDatas.front()->window.lock()->middle());
 
             return {};
@@ -893,12 +1008,14 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
                 c->columnWidth = abs;
             }
 
+            WDATA->column->workspace->invalidateOffsets();
             WDATA->column->workspace->recalculate();
             return {};
         }
 
         CScopeGuard x([WDATA] {
             WDATA->column->columnWidth = std::clamp(WDATA->column->columnWidth, MIN_COLUMN_WIDTH, MAX_COLUMN_WIDTH);
+            WDATA->column->workspace->invalidateOffsets();
             WDATA->column->workspace->fitCol(WDATA->column.lock());
             WDATA->column->workspace->recalculate();
         });
@@ -963,6 +1080,7 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
             const auto USABLE = usableAreaFor(WORKDATA->workspace->m_monitor.lock());
 
             WDATA->column->columnWidth = 1.F;
+            WORKDATA->invalidateOffsets();
 
             WORKDATA->leftOffset = 0;
             for (size_t i = 0; i < WORKDATA->columns.size(); ++i) {
@@ -985,6 +1103,7 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
                 c->columnWidth = 1.F / (float)LEN;
             }
 
+            WDATA->invalidateOffsets();
             WDATA->recalculate();
         } else if (ARGS[1] == "toend") {
             // fit all columns on screen that start from the current and end on the last
@@ -1010,6 +1129,8 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
             if (!begun)
                 return {};
 
+            WDATA->invalidateOffsets();
+
             const auto USABLE = usableAreaFor(WDATA->workspace->m_monitor.lock());
 
             WDATA->leftOffset = 0;
@@ -1042,6 +1163,8 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
             if (!begun)
                 return {};
 
+            WDATA->invalidateOffsets();
+
             WDATA->leftOffset = 0;
 
             WDATA->recalculate();
@@ -1087,6 +1210,8 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
                 v->columnWidth = 1.F / (float)visible.size();
             }
 
+            WDATA->invalidateOffsets();
+
             WDATA->recalculate();
         }
     } else if (ARGS[0] == "focus") {
@@ -1096,6 +1221,9 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
         if (!WDATA || ARGS[1].empty())
             return {};
 
+        // neighbors are found by their layout boxes, and warping reads positions
+        WDATA->column->workspace->flushRecalculate();
+
         switch (ARGS[1][0]) {
             case 'u':
             case 't': {
@@ -1133,6 +1261,7 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
                     if (*PNOFALLBACK) {
                         centerOrFit(WDATA->column->workspace.lock(), WDATA->column.lock());
                         WDATA->column->workspace->recalculate();
+                        WDATA->column->workspace->flushRecalculate();
                         g_pCompositor->warpCursorTo(WDATA->window.lock()->middle());
                         break;
                     } else
@@ -1143,6 +1272,7 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
                 g_pCompositor->focusWindow(pTargetWindowData->window.lock());
                 centerOrFit(WDATA->column->workspace.lock(), PREV);
                 WDATA->column->workspace->recalculate();
+                WDATA->column->workspace->flushRecalculate();
                 g_pCompositor->warpCursorTo(PREV->windowDatas.front()->window.lock()->middle());
                 break;
             }
@@ -1153,6 +1283,7 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
                     if (*PNOFALLBACK) {
                         centerOrFit(WDATA->column->workspace.lock(), WDATA->column.lock());
                         WDATA->column->workspace->recalculate();
+                        WDATA->column->workspace->flushRecalculate();
                         g_pCompositor->warpCursorTo(WDATA->window.lock()->middle());
                         break;
                     } else
@@ -1163,6 +1294,7 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
                 g_pCompositor->focusWindow(pTargetWindowData->window.lock());
                 centerOrFit(WDATA->column->workspace.lock(), NEXT);
                 WDATA->column->workspace->recalculate();
+                WDATA->column->workspace->flushRecalculate();
                 g_pCompositor->warpCursorTo(NEXT->windowDatas.front()->window.lock()->middle());
                 break;
             }
@@ -1216,6 +1348,7 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
             return {};
 
         std::swap(WS_DATA->columns[current_idx], WS_DATA->columns[target_idx]);
+        WS_DATA->invalidateOffsets();
         WS_DATA->centerOrFitCol(CURRENT_COL);
         WS_DATA->recalculate();
     } else if (ARGS[0] == "movecoltoworkspace") {
@@ -1279,18 +1412,18 @@ std::any CScrollingLayout::layoutMessage(SLayoutMessageHeader header, std::strin
             return {};
 
         auto targetWorkspaceData = dataFor(PWORKSPACE);
-        if (!targetWorkspaceData) {
-            targetWorkspaceData       = m_workspaceDatas.emplace_back(makeShared<SWorkspaceData>(PWORKSPACE, this));
-            targetWorkspaceData->self = targetWorkspaceData;
-        }
+        if (!targetWorkspaceData)
+            targetWorkspaceData = createWorkspaceData(PWORKSPACE);
 
         const auto NEW_COL = targetWorkspaceData->add();
 
         NEW_COL->columnWidth = CURRENT_COL->columnWidth;
         NEW_COL->windowDatas = CURRENT_COL->windowDatas;
+        targetWorkspaceData->invalidateOffsets();
 
         for (const auto& wd : NEW_COL->windowDatas) {
-            wd->column = NEW_COL;
+            wd->column     = NEW_COL;
+            wd->needsApply = true;
         }
 
         std::vector<PHLWINDOW> windowsToMove;
@@ -1379,6 +1512,7 @@ void CScrollingLayout::moveWindowTo(PHLWINDOW w, const std::string& dir, bool si
         DATA->column->down(DATA);
 
     WS->recalculate();
+    WS->flushRecalculate();
     g_pCompositor->warpCursorTo(w->middle());
 }
 
@@ -1399,35 +1533,96 @@ Vector2D CScrollingLayout::predictSizeForNewWindowTiled() {
 }
 
 SP<SWorkspaceData> CScrollingLayout::dataFor(PHLWORKSPACE ws) {
-    for (const auto& e : m_workspaceDatas) {
-        if (e->workspace != ws)
-            continue;
+    if (!ws)
+        return nullptr;
 
-        return e;
-    }
+    const auto IT = m_workspaceIndex.find(ws.get());
+    if (IT == m_workspaceIndex.end())
+        return nullptr;
 
-    return nullptr;
+    const auto DATA = IT->second.lock();
+
+    // a new workspace at the address of a dead one
+    if (!DATA || DATA->workspace != ws)
+        return nullptr;
+
+    return DATA;
 }
 
 SP<SScrollingWindowData> CScrollingLayout::dataFor(PHLWINDOW w) {
     if (!w)
         return nullptr;
 
-    for (const auto& e : m_workspaceDatas) {
-        if (e->workspace != w->m_workspace)
+    const auto IT = m_windowIndex.find(w.get());
+    if (IT == m_windowIndex.end())
+        return nullptr;
+
+    const auto DATA = IT->second.lock();
+
+    if (!DATA || DATA->window != w)
+        return nullptr;
+
+    // only while the window is on the workspace we have it in, it's on its way to another one otherwise
+    if (!DATA->column || !DATA->column->workspace || DATA->column->workspace->workspace != w->m_workspace)
+        return nullptr;
+
+    return DATA;
+}
+
+SP<SWorkspaceData> CScrollingLayout::createWorkspaceData(PHLWORKSPACE ws) {
+    auto data  = m_workspaceDatas.emplace_back(makeShared<SWorkspaceData>(ws, this));
+    data->self = data;
+
+    m_workspaceIndex[ws.get()] = data;
+
+    return data;
+}
+
+void CScrollingLayout::indexWindow(SP<SScrollingWindowData> data) {
+    if (const auto PWINDOW = data->window.lock())
+        m_windowIndex[PWINDOW.get()] = data;
+}
+
+void CScrollingLayout::unindexWindow(PHLWINDOW w) {
+    m_windowIndex.erase(w.get());
+}
+
+void CScrollingLayout::checkIndexes() {
+    size_t windows = 0;
+
+    for (const auto& ws : m_workspaceDatas) {
+        if (!ws->workspace)
             continue;
 
-        for (const auto& c : e->columns) {
-            for (const auto& d : c->windowDatas) {
-                if (d->window != w)
+        const auto IT = m_workspaceIndex.find(ws->workspace.get());
+        if (IT == m_workspaceIndex.end() || IT->second.lock() != ws)
+            Debug::log(ERR, "[scroller] index: workspace {} is not indexed to its data", ws->workspace->m_id);
+
+        for (const auto& col : ws->columns) {
+            if (col->workspace.lock() != ws)
+                Debug::log(ERR, "[scroller] index: column {:x} on workspace {} points at another workspace", (uintptr_t)col.get(), ws->workspace->m_id);
+
+            for (const auto& wd : col->windowDatas) {
+                windows++;
+
+                if (wd->column.lock() != col)
+                    Debug::log(ERR, "[scroller] index: node {:x} points at another column", (uintptr_t)wd.get());
+
+                const auto PWINDOW = wd->window.lock();
+                if (!PWINDOW) {
+                    Debug::log(ERR, "[scroller] index: node {:x} holds a dead window", (uintptr_t)wd.get());
                     continue;
+                }
 
-                return d;
+                const auto WIT = m_windowIndex.find(PWINDOW.get());
+                if (WIT == m_windowIndex.end() || WIT->second.lock() != wd)
+                    Debug::log(ERR, "[scroller] index: {} is not indexed to its node", PWINDOW);
             }
         }
     }
 
-    return nullptr;
+    if (m_windowIndex.size() != windows)
+        Debug::log(ERR, "[scroller] index: {} windows indexed but {} in the layout", m_windowIndex.size(), windows);
 }
 
 SP<SWorkspaceData> CScrollingLayout::currentWorkspaceData() {
@@ -1442,3 +1637,33 @@ SP<SWorkspaceData> CScrollingLayout::currentWorkspaceData() {
 CBox CScrollingLayout::usableAreaFor(PHLMONITOR m) {
     return CBox{m->m_reservedTopLeft, m->m_size - m->m_reservedTopLeft - m->m_reservedBottomRight};
 }
+
+SLayoutContext CScrollingLayout::layoutContextFor(PHLWORKSPACE ws) {
+    static auto    PGAPSINDATA  = CConfigValue<Hyprlang::CUSTOMTYPE>("general:gaps_in");
+    static auto    PGAPSOUTDATA = CConfigValue<Hyprlang::CUSTOMTYPE>("general:gaps_out");
+    static auto    PSCALEFACTOR = CConfigValue<Hyprlang::FLOAT>("dwindle:special_scale_factor");
+
+    SLayoutContext ctx;
+
+    if (!ws || !ws->m_monitor)
+        return ctx;
+
+    const auto PMONITOR = ws->m_monitor.lock();
+
+    ctx.monitor   = PMONITOR;
+    ctx.workspace = ws;
+    ctx.usable    = usableAreaFor(PMONITOR);
+    ctx.area      = ctx.usable.copy().translate(PMONITOR->m_position);
+
+    // get specific gaps and rules for this workspace,
+    // if user specified them in config
+    const auto  WORKSPACERULE = g_pConfigManager->getWorkspaceRuleFor(ws);
+    auto* const PGAPSIN       = (CCssGapData*)(PGAPSINDATA.ptr())->getData();
+    auto* const PGAPSOUT      = (CCssGapData*)(PGAPSOUTDATA.ptr())->getData();
+
+    ctx.gapsIn             = WORKSPACERULE.gapsIn.value_or(*PGAPSIN);
+    ctx.gapsOut            = WORKSPACERULE.gapsOut.value_or(*PGAPSOUT);
+    ctx.specialScaleFactor = *PSCALEFACTOR;
+
+    return ctx;
+}
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <vector>
+#include <unordered_map>
 #include <hyprland/src/layout/IHyprLayout.hpp>
 #include <hyprland/src/helpers/memory/Memory.hpp>
+#include <hyprland/src/config/ConfigDataValues.hpp>
 #include <hyprland/src/managers/HookSystemManager.hpp>
 
 class CScrollingLayout;
@@ -21,6 +23,12 @@ struct SScrollingWindowData {
     PHLWORKSPACEREF overrideWorkspace;
 
     CBox            layoutBox;
+
+    // what applyNodeDataToWindow last got from recalculate, which skips windows where that didn't change
+    CBox            appliedBox;
+    bool            appliedHasRight = false;
+    bool            appliedHasLeft  = false;
+    bool            needsApply      = true;
 };
 
 struct SColumnData {
@@ -48,9 +56,23 @@ struct SColumnData {
     float                                 columnWidth = 1.F;
     WP<SWorkspaceData>                    workspace;
 
+    // position in workspace->columns as of the last SWorkspaceData::columnOffsets rebuild
+    size_t                                cachedIdx = 0;
+
     WP<SColumnData>                       self;
 };
 
+// what applyNodeDataToWindow needs from the workspace rule, the config and the monitor, resolved once per layout pass
+struct SLayoutContext {
+    PHLMONITORREF   monitor;
+    PHLWORKSPACEREF workspace;
+    CBox            usable; // from usableAreaFor, relative to the monitor
+    CBox            area;   // usable in layout coordinates, windows touching its edges get gaps_out
+    CCssGapData     gapsIn;
+    CCssGapData     gapsOut;
+    float           specialScaleFactor = 1.F;
+};
+
 struct SWorkspaceData {
     SWorkspaceData(PHLWORKSPACE w, CScrollingLayout* l) : workspace(w), layout(l) {
         ;
@@ -74,10 +96,40 @@ struct SWorkspaceData {
     void                         fitCol(SP<SColumnData> c);
     void                         centerOrFitCol(SP<SColumnData> c);
 
+    // queues a layout pass for the next frame, so any number of calls before it cost one pass.
+    // forceInstant lays out now instead and warps the windows there
     void                         recalculate(bool forceInstant = false);
 
+    // runs the queued pass now, for callers reading window geometry right after recalculate
+    void                         flushRecalculate();
+
+    // lays out only w now, for Hyprland reading its geometry right away. The rest waits for the queued pass
+    void                         recalculateWindowNow(SP<SScrollingWindowData> w);
+
+    // makes the next recalculate apply every window, for changes their boxes don't show (gaps, rules, the monitor)
+    void                         invalidateWindows();
+
+    // left edge of every column in layout px, then the total width. Rebuilt on the next call after
+    // invalidateOffsets(), which anything adding, removing, reordering or resizing columns calls.
+    const std::vector<double>&   columnOffsets();
+    void                         invalidateOffsets();
+
     CScrollingLayout*            layout = nullptr;
     WP<SWorkspaceData>           self;
+
+  private:
+    // computes every box but applies only that window if only is set
+    void                layoutWindows(bool forceInstant, SP<SScrollingWindowData> only = nullptr);
+
+    bool                recalculatePending = false;
+
+    std::vector<double> offsets;
+    bool                offsetsValid       = false;
+    double              offsetsUsableWidth = 0;
+    bool                offsetsFSOnOne     = false;
+
+    // from the previous layout pass, windows are reapplied when gaps and the like differ from it
+    SLayoutContext      lastLayoutCtx;
 };
 
 class CScrollingLayout : public IHyprLayout {
@@ -103,12 +155,21 @@ class CScrollingLayout : public IHyprLayout {
     virtual void                     onDisable();
 
     CBox                             usableAreaFor(PHLMONITOR m);
+    SLayoutContext                   layoutContextFor(PHLWORKSPACE ws);
 
   private:
     std::vector<SP<SWorkspaceData>> m_workspaceDatas;
 
+    // so dataFor doesn't walk every workspace, column and window. Keyed by address, so a hit is checked against the data
+    std::unordered_map<const CWindow*, WP<SScrollingWindowData>> m_windowIndex;
+    std::unordered_map<const CWorkspace*, WP<SWorkspaceData>>    m_workspaceIndex;
+
     SP<HOOK_CALLBACK_FN>            m_configCallback;
     SP<HOOK_CALLBACK_FN>            m_focusCallback;
+    SP<HOOK_CALLBACK_FN>            m_preRenderCallback;
+
+    // from SWorkspaceData::recalculate, flushed in preRender
+    std::vector<WP<SWorkspaceData>> m_pendingRecalculations;
 
     struct {
         bool isMovingColumn    = false;
@@ -123,8 +184,17 @@ class CScrollingLayout : public IHyprLayout {
     SP<SWorkspaceData>       dataFor(PHLWORKSPACE ws);
     SP<SScrollingWindowData> dataFor(PHLWINDOW w);
     SP<SWorkspaceData>       currentWorkspaceData();
+    SP<SWorkspaceData>       createWorkspaceData(PHLWORKSPACE ws);
+
+    // from SColumnData::add and remove, the only places windows enter or leave a column
+    void                     indexWindow(SP<SScrollingWindowData> data);
+    void                     unindexWindow(PHLWINDOW w);
+
+    // with plugin:hyprscrolling:debug_check_indexes, logs where the indexes disagree with the layout
+    void                     checkIndexes();
 
-    void                     applyNodeDataToWindow(SP<SScrollingWindowData> node, bool instant, bool hasWindowsRight, bool hasWindowsLeft);
+    void                     applyNodeDataToWindow(SP<SScrollingWindowData> node, const SLayoutContext& ctx, bool instant, bool hasWindowsRight, bool hasWindowsLeft);
 
     friend struct SWorkspaceData;
+    friend struct SColumnData;
 };
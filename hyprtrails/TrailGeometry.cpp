@@ -0,0 +1,257 @@
+#include "TrailGeometry.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "bezier.hpp"
+
+// plugin:hyprtrails:adaptive_step never makes segments shorter than this, in physical px, they'd be wasted
+constexpr double ADAPTIVE_MIN_SEGMENT_PX = 2;
+
+// plugin:hyprtrails:bezier_step is clamped to this, 0 or less would never finish a curve
+constexpr float MIN_BEZIER_STEP = 0.001F;
+
+static STrailPoint vecForT(const STrailPoint& a, const STrailPoint& b, float t) {
+    return STrailPoint{a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t};
+}
+
+static double distanceToSegment(const STrailPoint& p, const STrailPoint& a, const STrailPoint& b) {
+    const double DX    = b.x - a.x;
+    const double DY    = b.y - a.y;
+    const double LENSQ = DX * DX + DY * DY;
+    const double T     = LENSQ > 0 ? std::clamp(((p.x - a.x) * DX + (p.y - a.y) * DY) / LENSQ, 0.0, 1.0) : 0.0;
+    return std::hypot(p.x - (a.x + DX * T), p.y - (a.y + DY * T));
+}
+
+/*
+    points are in logical px, scale turns them into physical ones.
+
+    A degree n curve is at most n(n-1)/8 * max|P[i+2] - 2P[i+1] + P[i]| / N^2 away from its N segment polyline,
+    but that grows with n^2 and trails have 20 to 80 points, so on its own it asks for hundreds of samples.
+    The curve also stays in the hull of its control points, so it's never further than their deviation d from
+    its chord, and a curve that bends by d is within about d / N^2 of its polyline. We take whichever is lower.
+    A straight trail needs no samples in between, the ages along it are interpolated either way.
+*/
+size_t adaptiveSampleCount(const std::vector<STrailPoint>& points, double scale, double flatness, size_t maxSamples) {
+    if (points.size() < 2)
+        return 2;
+
+    const size_t DEGREE = points.size() - 1;
+
+    double length        = 0;
+    double maxSecondDiff = 0;
+    double deviation     = 0;
+
+    for (size_t i = 0; i < DEGREE; ++i) {
+        length += std::hypot(points[i + 1].x - points[i].x, points[i + 1].y - points[i].y);
+
+        if (i + 2 <= DEGREE)
+            maxSecondDiff = std::max(maxSecondDiff, std::hypot(points[i + 2].x - 2 * points[i + 1].x + points[i].x, points[i + 2].y - 2 * points[i + 1].y + points[i].y));
+
+        if (i > 0)
+            deviation = std::max(deviation, distanceToSegment(points[i], points.front(), points.back()));
+    }
+
+    length *= scale;
+    maxSecondDiff *= scale;
+    deviation *= scale;
+
+    const double FLATNESS     = std::max(flatness, 0.01);
+    const double FORSECONDDIF = std::ceil(std::sqrt(DEGREE * (DEGREE - 1) * maxSecondDiff / (8.0 * FLATNESS)));
+    const double FORDEVIATION = std::ceil(std::sqrt(deviation / FLATNESS));
+    const double MOSTUSEFUL   = std::ceil(length / ADAPTIVE_MIN_SEGMENT_PX);
+
+    const double SAMPLES = std::min({FORSECONDDIF, FORDEVIATION, MOSTUSEFUL, (double)maxSamples});
+
+    return std::max<size_t>(SAMPLES, 2);
+}
+
+void buildTrailGeometry(const CTrailHistory& history, const STrailGeometryParams& params, STrailGeometry& out, STrailGeometryScratch& scratch) {
+    out.clear();
+
+    auto& pointsForBezier = scratch.pointsForBezier;
+    auto& agesForBezier   = scratch.agesForBezier;
+    auto& bezierPts       = scratch.bezierPts;
+
+    pointsForBezier.clear();
+    agesForBezier.clear();
+    bezierPts.clear();
+
+    pointsForBezier.push_back(params.windowMiddle);
+    agesForBezier.push_back(0);
+
+    for (size_t i = 0; i < history.size(); i += 1) {
+        const STrailPoint MIDDLE = {history.x(i) - params.monitorPos.x + history.w(i) / 2.0, history.y(i) - params.monitorPos.y + history.h(i) / 2.0};
+
+        if (MIDDLE == pointsForBezier.back())
+            continue;
+
+        pointsForBezier.push_back(MIDDLE);
+        agesForBezier.push_back(history.ageMs(i, params.now));
+    }
+
+    // maxAge can only be 0 if every point was recorded at once, and we'd divide by it
+    if (pointsForBezier.size() < 3 || agesForBezier.back() <= 0)
+        return;
+
+    const STrailPoint MONSIZE = params.monitorSize;
+
+    // the head is a diamond around the window middle, always at full width.
+    // Instanced, the strip just starts at the window middle, it's behind the window either way.
+    const point2 HEAD = {(float)(params.windowMiddle.x / MONSIZE.x), (float)(params.windowMiddle.y / MONSIZE.y)};
+    const point2 UNIT = {(float)(1.0 / MONSIZE.x), (float)(1.0 / MONSIZE.y)};
+    if (params.instanced) {
+        // samples are padded with their first and last one, so every segment has both neighbors
+        out.samples.push_back({HEAD});
+        out.samples.push_back({HEAD});
+    } else {
+        out.vertices.push_back({HEAD, {UNIT.x, UNIT.y}});
+        out.vertices.push_back({HEAD, {UNIT.y, -UNIT.x}});
+        out.vertices.push_back({HEAD, {-UNIT.y, UNIT.x}});
+        out.vertices.push_back({HEAD, {-UNIT.x, -UNIT.y}});
+    }
+
+    // the window middle does not age, every history point ages with the clock
+    auto  slopeFor = [](float idx) -> float { return idx == 0 ? 0.F : 1.F; };
+
+    float maxAge          = agesForBezier.back();
+    float tCoeff          = std::max(MIN_BEZIER_STEP, params.bezierStep); // this order also turns NaN into the minimum
+    int   pointsPerBezier = params.pointsPerStep;
+
+    if (params.adaptive) {
+        // never more than the fixed step would use, that's already fine for any curve
+        const size_t FIXEDSAMPLES = std::ceil(1.0 / tCoeff) * std::max(params.pointsPerStep, 1);
+
+        // one vertex pair per sample, extra points in between would only ever lie on the chord
+        tCoeff          = 1.0 / adaptiveSampleCount(pointsForBezier, params.monitorScale, params.flatness, std::min(params.maxSamples, FIXEDSAMPLES));
+        pointsPerBezier = 1;
+    }
+
+    bezierPts.push_back(vecForBezierT(0, pointsForBezier, scratch.bezierScratch));
+    for (float t = tCoeff; t <= 1.0; t += tCoeff) {
+        bezierPts.push_back(vecForBezierT(t, pointsForBezier, scratch.bezierScratch));
+
+        const STrailPoint& lastbezier     = bezierPts.back();
+        const STrailPoint& lastprevbezier = bezierPts[bezierPts.size() - 2];
+
+        for (int i = 1; i < pointsPerBezier + 1; ++i) {
+            const float       bezierPointStep = (1.0 / (pointsPerBezier + 2));
+            const STrailPoint middle          = vecForT(lastprevbezier, lastbezier, bezierPointStep * (i + 1));
+            const STrailPoint lastmiddle      = vecForT(lastprevbezier, lastbezier, bezierPointStep * i);
+
+            // interpolate the age, and how fast it grows, between the two closest history points
+            float ageCoeff  = t * (agesForBezier.size() - 1);
+            float ageFloor  = std::floor(ageCoeff);
+            float ageCeil   = std::ceil(ageCoeff);
+            float approxAge = agesForBezier[(int)ageFloor] + (agesForBezier[(int)ageCeil] - agesForBezier[(int)ageFloor]) * (ageCoeff - ageFloor);
+            float ageSlope  = slopeFor(ageFloor) + (slopeFor(ageCeil) - slopeFor(ageFloor)) * (ageCoeff - ageFloor);
+
+            // widths only ever shrink, so a point that is already at zero stays there
+            if (approxAge >= maxAge)
+                continue;
+
+            const point2 MIDDLE = {(float)(middle.x / MONSIZE.x), (float)(middle.y / MONSIZE.y)};
+
+            // the vertex shader extrudes from the neighbors
+            if (params.instanced) {
+                out.samples.push_back({MIDDLE, approxAge, ageSlope});
+                continue;
+            }
+
+            STrailPoint vecNormal = {middle.x - lastmiddle.x, middle.y - lastmiddle.y};
+
+            // normalize vec
+            float invlen = 1.0 / std::sqrt(vecNormal.x * vecNormal.x + vecNormal.y * vecNormal.y);
+            vecNormal.x *= invlen;
+            vecNormal.y *= invlen;
+
+            if (std::isnan(vecNormal.x) || std::isnan(vecNormal.y))
+                continue;
+
+            // rotate by 90 and -90, the width gets applied in the shader
+            out.vertices.push_back({MIDDLE, {(float)(-vecNormal.y / MONSIZE.y), (float)(vecNormal.x / MONSIZE.x)}, approxAge, ageSlope});
+            out.vertices.push_back({MIDDLE, {(float)(vecNormal.y / MONSIZE.y), (float)(-vecNormal.x / MONSIZE.x)}, approxAge, ageSlope});
+        }
+    }
+
+    out.maxAge        = maxAge;
+    out.bezierSamples = bezierPts.size();
+
+    if (params.instanced) {
+        // head, padding and at least one segment
+        if (out.samples.size() < 3) {
+            out.samples.clear();
+            return;
+        }
+
+        out.samples.push_back(out.samples.back());
+    }
+
+    // calculate damage per segment, widths at build time are the largest they will get.
+    // Neighboring segments get merged as long as that wastes at most tolerance^2 px, so a
+    // straight run becomes one box and a diagonal or a corner doesn't damage its whole AABB.
+    const double TOLERANCE = std::max(params.damageTolerance, 0.0);
+
+    STrailRect   current;
+    bool         hasCurrent = false;
+
+    auto         addSegment = [&](double minX, double minY, double maxX, double maxY) {
+        // bring back to global coords, rounded outwards so fractional edges stay covered
+        minX = std::floor(minX * MONSIZE.x + params.monitorPos.x);
+        minY = std::floor(minY * MONSIZE.y + params.monitorPos.y);
+        maxX = std::ceil(maxX * MONSIZE.x + params.monitorPos.x);
+        maxY = std::ceil(maxY * MONSIZE.y + params.monitorPos.y);
+
+        const STrailRect SEGMENT = {minX, minY, maxX - minX, maxY - minY};
+
+        if (!hasCurrent) {
+            current    = SEGMENT;
+            hasCurrent = true;
+            return;
+        }
+
+        const double     UX     = std::min(current.x, SEGMENT.x);
+        const double     UY     = std::min(current.y, SEGMENT.y);
+        const STrailRect MERGED = {UX, UY, std::max(current.x + current.w, SEGMENT.x + SEGMENT.w) - UX, std::max(current.y + current.h, SEGMENT.y + SEGMENT.h) - UY};
+
+        if (MERGED.w * MERGED.h - current.w * current.h - SEGMENT.w * SEGMENT.h <= TOLERANCE * TOLERANCE) {
+            current = MERGED;
+            return;
+        }
+
+        out.damage.push_back(current);
+        current = SEGMENT;
+    };
+
+    // every triangle of the strip lies within 4 consecutive vertices starting at an even index
+    for (size_t i = 0; i + 3 < out.vertices.size(); i += 2) {
+        double minX = 1e9, minY = 1e9, maxX = -1e9, maxY = -1e9;
+
+        for (size_t j = i; j < i + 4; ++j) {
+            const auto& V     = out.vertices[j];
+            const float WIDTH = params.width * (1.0 - (V.age / maxAge));
+            const float X     = V.pos.x + V.offset.x * WIDTH;
+            const float Y     = V.pos.y + V.offset.y * WIDTH;
+            minX              = std::min<double>(minX, X);
+            minY              = std::min<double>(minY, Y);
+            maxX              = std::max<double>(maxX, X);
+            maxY              = std::max<double>(maxY, Y);
+        }
+
+        addSegment(minX, minY, maxX, maxY);
+    }
+
+    // we don't know the extrusion direction here, assume the worst. The padding samples add no segments.
+    for (size_t i = 1; i + 2 < out.samples.size(); ++i) {
+        const auto& A      = out.samples[i];
+        const auto& B      = out.samples[i + 1];
+        const float WIDTHA = params.width * (1.0 - (A.age / maxAge));
+        const float WIDTHB = params.width * (1.0 - (B.age / maxAge));
+
+        addSegment(std::min(A.pos.x - WIDTHA * UNIT.x, B.pos.x - WIDTHB * UNIT.x), std::min(A.pos.y - WIDTHA * UNIT.y, B.pos.y - WIDTHB * UNIT.y),
+                   std::max(A.pos.x + WIDTHA * UNIT.x, B.pos.x + WIDTHB * UNIT.x), std::max(A.pos.y + WIDTHA * UNIT.y, B.pos.y + WIDTHB * UNIT.y));
+    }
+
+    if (hasCurrent)
+        out.damage.push_back(current);
+}
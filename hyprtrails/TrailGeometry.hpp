@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "TrailHistory.hpp"
+
+// The pure geometry of a trail: history -> bezier -> strip -> damage.
+// Has no GL or compositor dependencies, so it can be benchmarked on its own.
+
+struct point2 {
+    float x = 0, y = 0;
+};
+
+// double precision point, in logical px
+struct STrailPoint {
+    double x = 0, y = 0;
+
+    bool   operator==(const STrailPoint&) const = default;
+};
+
+struct STrailRect {
+    double x = 0, y = 0, w = 0, h = 0;
+};
+
+// one vertex of the trail strip, the width is applied in the shader.
+// pos and offset are in monitor-normalized coords, offset is for a width of 1px.
+struct STrailVertex {
+    point2 pos;
+    point2 offset;
+    float  age      = 0; // age when the mesh was built
+    float  ageSlope = 0; // how much of the time since the mesh was built gets added to age
+};
+
+// one bezier sample for plugin:hyprtrails:gpu_extrude, the vertex shader extrudes it
+struct STrailSample {
+    point2 pos;
+    float  age      = 0;
+    float  ageSlope = 0;
+};
+
+struct STrailGeometryParams {
+    STrailPoint                      windowMiddle; // monitor-local
+    STrailPoint                      monitorPos;
+    STrailPoint                      monitorSize;
+    double                           monitorScale = 1;
+    CTrailHistory::clock::time_point now;
+
+    // width of the trail head, in logical px
+    float  width = 50;
+
+    // samples for the vertex shader to extrude instead of a strip
+    bool   instanced = false;
+
+    float  bezierStep    = 0.025;
+    int    pointsPerStep = 2;
+
+    // picks the step from the curve instead, see plugin:hyprtrails:adaptive_step
+    bool   adaptive   = false;
+    float  flatness   = 0.5; // physical px
+    size_t maxSamples = std::numeric_limits<size_t>::max();
+
+    // merging two damage rects may waste up to damageTolerance^2 px
+    double damageTolerance = 16;
+};
+
+struct STrailGeometry {
+    float                     maxAge = 0;
+
+    // either the strip, or its padded centers when instanced
+    std::vector<STrailVertex> vertices;
+    std::vector<STrailSample> samples;
+
+    // global logical px, widths at build time are the largest they will get
+    std::vector<STrailRect>   damage;
+
+    size_t                    bezierSamples = 0;
+
+    void clear() {
+        maxAge = 0;
+        vertices.clear();
+        samples.clear();
+        damage.clear();
+        bezierSamples = 0;
+    }
+
+    bool empty() const {
+        return vertices.empty() && samples.empty();
+    }
+};
+
+// kept between builds, so a rebuild doesn't allocate once it's warmed up
+struct STrailGeometryScratch {
+    std::vector<STrailPoint> pointsForBezier;
+    std::vector<float>       agesForBezier;
+    std::vector<STrailPoint> bezierPts;
+    std::vector<STrailPoint> bezierScratch;
+};
+
+// returns the sample count plugin:hyprtrails:adaptive_step picks for a curve, never above maxSamples or below 2
+size_t adaptiveSampleCount(const std::vector<STrailPoint>& points, double scale, double flatness, size_t maxSamples);
+
+// rebuilds out from history, leaves it empty if there is nothing to draw
+void   buildTrailGeometry(const CTrailHistory& history, const STrailGeometryParams& params, STrailGeometry& out, STrailGeometryScratch& scratch);
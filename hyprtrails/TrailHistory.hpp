@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+// Fixed-capacity ring buffer of window boxes, newest first. Stored as separate
+// x / y / w / h / time arrays. Has no compositor dependencies.
+class CTrailHistory {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    // keeps the newest entries that still fit
+    void setCapacity(size_t capacity) {
+        if (capacity == m_capacity)
+            return;
+
+        const size_t       KEEP = std::min(m_size, capacity);
+
+        std::vector<float> x(capacity), y(capacity), w(capacity), h(capacity);
+        std::vector<clock::time_point> time(capacity);
+
+        // re-pack so the newest entry is at 0
+        for (size_t i = 0; i < KEEP; ++i) {
+            const size_t IDX = indexOf(i);
+            x[i]             = m_x[IDX];
+            y[i]             = m_y[IDX];
+            w[i]             = m_w[IDX];
+            h[i]             = m_h[IDX];
+            time[i]          = m_time[IDX];
+        }
+
+        m_x        = std::move(x);
+        m_y        = std::move(y);
+        m_w        = std::move(w);
+        m_h        = std::move(h);
+        m_time     = std::move(time);
+        m_capacity = capacity;
+        m_size     = KEEP;
+        m_head     = 0;
+    }
+
+    // adds a new newest entry, dropping the oldest one if full
+    void push(float x, float y, float w, float h, clock::time_point time) {
+        if (m_capacity == 0)
+            return;
+
+        m_head = (m_head + m_capacity - 1) % m_capacity;
+
+        m_x[m_head]    = x;
+        m_y[m_head]    = y;
+        m_w[m_head]    = w;
+        m_h[m_head]    = h;
+        m_time[m_head] = time;
+
+        if (m_size < m_capacity)
+            m_size++;
+    }
+
+    void clear() {
+        m_size = 0;
+    }
+
+    // sets the timestamp of every entry
+    void restamp(clock::time_point time) {
+        for (size_t i = 0; i < m_size; ++i) {
+            m_time[indexOf(i)] = time;
+        }
+    }
+
+    // whether every entry is exactly this box
+    bool allEqual(float x, float y, float w, float h) const {
+        for (size_t i = 0; i < m_size; ++i) {
+            const size_t IDX = indexOf(i);
+            if (m_x[IDX] != x || m_y[IDX] != y || m_w[IDX] != w || m_h[IDX] != h)
+                return false;
+        }
+
+        return true;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+    size_t capacity() const {
+        return m_capacity;
+    }
+
+    bool empty() const {
+        return m_size == 0;
+    }
+
+    bool full() const {
+        return m_size == m_capacity;
+    }
+
+    // i = 0 is the newest entry
+    float x(size_t i) const {
+        return m_x[indexOf(i)];
+    }
+
+    float y(size_t i) const {
+        return m_y[indexOf(i)];
+    }
+
+    float w(size_t i) const {
+        return m_w[indexOf(i)];
+    }
+
+    float h(size_t i) const {
+        return m_h[indexOf(i)];
+    }
+
+    clock::time_point time(size_t i) const {
+        return m_time[indexOf(i)];
+    }
+
+    // age of entry i at now, in ms
+    float ageMs(size_t i, clock::time_point now) const {
+        return ageMsBetween(time(i), now);
+    }
+
+    // never negative, so a stale now can't produce negative ages or NaN widths
+    static float ageMsBetween(clock::time_point then, clock::time_point now) {
+        if (now <= then)
+            return 0.F;
+
+        return std::chrono::duration<float, std::milli>(now - then).count();
+    }
+
+  private:
+    size_t indexOf(size_t i) const {
+        return (m_head + i) % m_capacity;
+    }
+
+    std::vector<float>             m_x, m_y, m_w, m_h;
+    std::vector<clock::time_point> m_time;
+
+    size_t                         m_capacity = 0;
+    size_t                         m_size     = 0;
+    size_t                         m_head     = 0;
+};
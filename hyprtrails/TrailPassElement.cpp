@@ -2,12 +2,16 @@
 #include <hyprland/src/render/OpenGL.hpp>
 #include "trail.hpp"
 
+#include <span>
+
 CTrailPassElement::CTrailPassElement(const CTrailPassElement::STrailData& data_) : data(data_) {
     ;
 }
 
 void CTrailPassElement::draw(const CRegion& damage) {
-    data.deco->renderPass(g_pHyprOpenGL->m_renderData.pMonitor.lock(), data.a);
+    const auto PMONITOR = g_pHyprOpenGL->m_renderData.pMonitor.lock();
+
+    CTrail::renderBatch(PMONITOR, std::span<CTrail* const>(&data.deco, 1));
 }
 
 bool CTrailPassElement::needsLiveBlur() {
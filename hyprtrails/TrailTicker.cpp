@@ -0,0 +1,88 @@
+#include "TrailTicker.hpp"
+
+#include <hyprland/src/Compositor.hpp>
+#include <hyprland/src/render/Renderer.hpp>
+
+#include "trail.hpp"
+
+CTrailTicker::CTrailTicker() {
+    m_pTimer = wl_event_loop_add_timer(g_pCompositor->m_wlEventLoop, &CTrailTicker::onTimer, this);
+}
+
+CTrailTicker::~CTrailTicker() {
+    while (m_pActiveHead) {
+        remove(m_pActiveHead);
+    }
+
+    wl_event_source_remove(m_pTimer);
+}
+
+int CTrailTicker::onTimer(void* data) {
+    ((CTrailTicker*)data)->tick();
+    return 0;
+}
+
+void CTrailTicker::add(CTrail* trail) {
+    if (trail->m_bTickActive)
+        return;
+
+    trail->m_bTickActive = true;
+    trail->m_pPrevActive = nullptr;
+    trail->m_pNextActive = m_pActiveHead;
+
+    if (m_pActiveHead)
+        m_pActiveHead->m_pPrevActive = trail;
+
+    m_pActiveHead = trail;
+    m_iActive++;
+
+    if (!m_bArmed)
+        arm();
+}
+
+void CTrailTicker::remove(CTrail* trail) {
+    if (!trail->m_bTickActive)
+        return;
+
+    if (trail->m_pPrevActive)
+        trail->m_pPrevActive->m_pNextActive = trail->m_pNextActive;
+    else
+        m_pActiveHead = trail->m_pNextActive;
+
+    if (trail->m_pNextActive)
+        trail->m_pNextActive->m_pPrevActive = trail->m_pPrevActive;
+
+    trail->m_pPrevActive = nullptr;
+    trail->m_pNextActive = nullptr;
+    trail->m_bTickActive = false;
+    m_iActive--;
+}
+
+size_t CTrailTicker::activeCount() const {
+    return m_iActive;
+}
+
+void CTrailTicker::tick() {
+    m_bArmed = false;
+
+    for (CTrail* trail = m_pActiveHead; trail;) {
+        // remove() clears the links, grab next first
+        CTrail* next = trail->m_pNextActive;
+
+        if (!trail->onTick())
+            remove(trail);
+
+        trail = next;
+    }
+
+    // nothing is moving, stay asleep until a trail wakes us up again
+    if (m_pActiveHead)
+        arm();
+}
+
+void CTrailTicker::arm() {
+    // a timeout of 0 would disarm the timer
+    const int TIMEOUT = g_pHyprRenderer->m_mostHzMonitor ? std::max(1, (int)(1000.0 / g_pHyprRenderer->m_mostHzMonitor->m_refreshRate)) : 16;
+    wl_event_source_timer_update(m_pTimer, TIMEOUT);
+    m_bArmed = true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <wayland-server-core.h>
+
+class CTrail;
+
+// Drives onTick for every trail from one timer. Trails that have nothing left to
+// animate drop off the active list, and the timer is disarmed while the list is empty.
+class CTrailTicker {
+  public:
+    CTrailTicker();
+    ~CTrailTicker();
+
+    // puts the trail on the active list, arming the timer if needed
+    void add(CTrail* trail);
+
+    // takes the trail off the active list, if it is on it
+    void remove(CTrail* trail);
+
+    // trails currently on the active list
+    size_t activeCount() const;
+
+  private:
+    static int       onTimer(void* data);
+    void             tick();
+    void             arm();
+
+    CTrail*          m_pActiveHead = nullptr;
+    size_t           m_iActive     = 0;
+
+    wl_event_source* m_pTimer = nullptr;
+    bool             m_bArmed = false;
+};
@@ -0,0 +1,100 @@
+// Micro-benchmark for the trail bezier evaluator.
+// Compares vecForBezierT from bezier.hpp with the recursive implementation it replaced.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../bezier.hpp"
+
+struct SVec {
+    double x = 0, y = 0;
+
+    SVec operator-(const SVec& o) const {
+        return SVec{x - o.x, y - o.y};
+    }
+    SVec operator+(const SVec& o) const {
+        return SVec{x + o.x, y + o.y};
+    }
+    SVec operator*(double c) const {
+        return SVec{x * c, y * c};
+    }
+};
+
+static SVec vecForT(const SVec& a, const SVec& b, const float& t) {
+    const SVec vec_PQ = b - a;
+    return SVec{a + vec_PQ * t};
+}
+
+// the old implementation, kept verbatim for reference
+static SVec vecForBezierTRecursive(const float& t, const std::vector<SVec>& verts) {
+    std::vector<SVec> pts;
+
+    for (size_t vertexIndex = 0; vertexIndex < verts.size() - 1; vertexIndex++) {
+        SVec p = verts[vertexIndex];
+        pts.push_back(vecForT(p, verts[vertexIndex + 1], t));
+    }
+
+    if (pts.size() > 1)
+        return vecForBezierTRecursive(t, pts);
+    else
+        return pts[0];
+}
+
+template <typename FN>
+static double nsPerFrame(FN&& fn, int frames) {
+    const auto BEGIN = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        fn();
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEGIN).count() / (double)frames;
+}
+
+int main() {
+    constexpr float BEZIERSTEP = 0.025F;
+    constexpr int   FRAMES     = 200;
+
+    std::mt19937    rng(1337);
+
+    std::printf("%8s %16s %16s %10s %12s\n", "points", "recursive ns/f", "bernstein ns/f", "speedup", "max error");
+
+    for (size_t historyPoints : {8, 16, 32, 48, 64, 96, 128}) {
+        std::vector<SVec>                      verts;
+        std::uniform_real_distribution<double> dist(0, 2000);
+        for (size_t i = 0; i < historyPoints + 1; ++i) {
+            verts.push_back(SVec{dist(rng), dist(rng)});
+        }
+
+        std::vector<SVec> scratch;
+        volatile double   sink = 0;
+
+        const double OLDNS = nsPerFrame(
+            [&] {
+                for (float t = 0; t <= 1.0; t += BEZIERSTEP) {
+                    sink = sink + vecForBezierTRecursive(t, verts).x;
+                }
+            },
+            FRAMES);
+
+        const double NEWNS = nsPerFrame(
+            [&] {
+                for (float t = 0; t <= 1.0; t += BEZIERSTEP) {
+                    sink = sink + vecForBezierT(t, verts, scratch).x;
+                }
+            },
+            FRAMES);
+
+        double maxError = 0;
+        for (float t = 0; t <= 1.0; t += BEZIERSTEP) {
+            const auto A = vecForBezierTRecursive(t, verts);
+            const auto B = vecForBezierT(t, verts, scratch);
+            maxError     = std::max(maxError, std::max(std::abs(A.x - B.x), std::abs(A.y - B.y)));
+        }
+
+        std::printf("%8zu %16.0f %16.0f %9.1fx %12.2e\n", historyPoints, OLDNS, NEWNS, OLDNS / NEWNS, maxError);
+    }
+
+    return 0;
+}
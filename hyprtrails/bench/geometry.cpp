@@ -0,0 +1,237 @@
+// Benchmark for the trail geometry (history -> bezier -> strip -> damage).
+// Replays window-motion traces through buildTrailGeometry and reports time, allocations and vertex counts per frame.
+//
+// Usage: hyprtrails-bench-geometry [trace]
+// A trace has one "x y w h" window box per line, one line per frame. Without one, synthetic traces are used.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../TrailGeometry.hpp"
+
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    g_allocations++;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+struct SWindowBox {
+    float x = 0, y = 0, w = 0, h = 0;
+};
+
+struct STrace {
+    std::string             name;
+    std::vector<SWindowBox> frames;
+};
+
+constexpr double MONITOR_W = 2560;
+constexpr double MONITOR_H = 1440;
+constexpr double FRAME_MS  = 1000.0 / 60.0;
+constexpr int    FRAMES    = 600;
+
+static STrace lineTrace() {
+    STrace trace{.name = "line", .frames = {}};
+    for (int i = 0; i < FRAMES; ++i) {
+        // back and forth across the monitor
+        const double T = std::fmod(i / 120.0, 2.0);
+        const double X = T < 1 ? T : 2 - T;
+        trace.frames.push_back({(float)(X * (MONITOR_W - 800)), 300, 800, 600});
+    }
+    return trace;
+}
+
+static STrace straightTrace() {
+    // one way across the monitor, so the whole trail is one straight line
+    STrace trace{.name = "straight", .frames = {}};
+    for (int i = 0; i < FRAMES; ++i) {
+        trace.frames.push_back({(float)(i * (MONITOR_W - 800) / FRAMES), 300, 800, 600});
+    }
+    return trace;
+}
+
+static STrace circleTrace() {
+    STrace trace{.name = "circle", .frames = {}};
+    for (int i = 0; i < FRAMES; ++i) {
+        const double A = i / 40.0;
+        trace.frames.push_back({(float)(880 + std::cos(A) * 500), (float)(420 + std::sin(A) * 300), 800, 600});
+    }
+    return trace;
+}
+
+static STrace dragTrace() {
+    // a mouse drag, with short pauses
+    STrace                                 trace{.name = "drag", .frames = {}};
+    std::mt19937                           rng(1337);
+    std::uniform_real_distribution<double> dist(-40, 40);
+    double                                 x = 800, y = 400, vx = 0, vy = 0;
+    for (int i = 0; i < FRAMES; ++i) {
+        if (i % 90 < 20) {
+            vx = vy = 0;
+        } else {
+            vx = std::clamp(vx + dist(rng) * 0.3, -40.0, 40.0);
+            vy = std::clamp(vy + dist(rng) * 0.3, -40.0, 40.0);
+        }
+        x = std::clamp(x + vx, 0.0, MONITOR_W - 800);
+        y = std::clamp(y + vy, 0.0, MONITOR_H - 600);
+        trace.frames.push_back({(float)x, (float)y, 800, 600});
+    }
+    return trace;
+}
+
+static bool loadTrace(const char* path, STrace& trace) {
+    std::ifstream file(path);
+    if (!file.good())
+        return false;
+
+    trace.name = path;
+
+    SWindowBox box;
+    while (file >> box.x >> box.y >> box.w >> box.h) {
+        trace.frames.push_back(box);
+    }
+
+    return !trace.frames.empty();
+}
+
+struct SResult {
+    double nsPerFrame          = 0;
+    double allocsPerFrame      = 0;
+    double verticesPerFrame    = 0;
+    double damageRectsPerFrame = 0;
+};
+
+// the history records every historyStep frames like CTrail::onTick, the geometry is rebuilt every frame like while a window moves
+static SResult replay(const STrace& trace, STrailGeometryParams params, size_t historyPoints, int historyStep) {
+    CTrailHistory         history;
+    STrailGeometry        geometry;
+    STrailGeometryScratch scratch;
+
+    history.setCapacity(historyPoints);
+
+    const auto START = CTrailHistory::clock::now();
+
+    // the first frames only fill the history and warm up the scratch
+    const size_t WARMUP = std::min(trace.frames.size() / 2, historyPoints * historyStep);
+
+    size_t       frames = 0, vertices = 0, damageRects = 0, allocations = 0;
+    double       ns     = 0;
+    int          timer  = 0;
+
+    for (size_t i = 0; i < trace.frames.size(); ++i) {
+        const auto& BOX = trace.frames[i];
+        const auto  NOW = START + std::chrono::duration_cast<CTrailHistory::clock::duration>(std::chrono::duration<double, std::milli>(i * FRAME_MS));
+
+        if (++timer > historyStep) {
+            history.push(BOX.x, BOX.y, BOX.w, BOX.h, NOW);
+            timer = 0;
+        }
+
+        params.windowMiddle = {BOX.x + BOX.w / 2.0, BOX.y + BOX.h / 2.0};
+        params.now          = NOW;
+
+        const size_t ALLOCSBEFORE = g_allocations;
+        const auto   BEGIN        = std::chrono::steady_clock::now();
+
+        buildTrailGeometry(history, params, geometry, scratch);
+
+        const auto END = std::chrono::steady_clock::now();
+
+        if (i < WARMUP)
+            continue;
+
+        frames++;
+        ns += std::chrono::duration<double, std::nano>(END - BEGIN).count();
+        allocations += g_allocations - ALLOCSBEFORE;
+        vertices += params.instanced ? geometry.samples.size() : geometry.vertices.size();
+        damageRects += geometry.damage.size();
+    }
+
+    if (frames == 0)
+        return {};
+
+    return SResult{ns / frames, (double)allocations / frames, (double)vertices / frames, (double)damageRects / frames};
+}
+
+int main(int argc, char** argv) {
+    constexpr int       HISTORYSTEP = 2;
+
+    std::vector<STrace> traces;
+
+    if (argc > 1) {
+        STrace trace;
+        if (!loadTrace(argv[1], trace)) {
+            std::fprintf(stderr, "couldn't read a trace from %s\n", argv[1]);
+            return 1;
+        }
+        traces.push_back(std::move(trace));
+    } else {
+        traces.push_back(lineTrace());
+        traces.push_back(straightTrace());
+        traces.push_back(circleTrace());
+        traces.push_back(dragTrace());
+    }
+
+    std::printf("%-8s %-10s %7s %7s %12s %12s %12s %12s\n", "trace", "mode", "points", "step", "ns/frame", "allocs/f", "vertices/f", "damage/f");
+
+    bool moreThanFixed = false;
+
+    for (const auto& trace : traces) {
+        for (size_t historyPoints : {10, 20, 40, 80}) {
+            STrailGeometryParams params;
+            params.monitorSize = {MONITOR_W, MONITOR_H};
+
+            const float DEFAULTSTEP   = params.bezierStep;
+            double      fixedVertices = 0;
+
+            for (float step : {0.05F, 0.025F, 0.01F}) {
+                params.bezierStep = step;
+
+                for (bool instanced : {false, true}) {
+                    params.instanced = instanced;
+
+                    const auto RESULT = replay(trace, params, historyPoints, HISTORYSTEP);
+                    if (step == DEFAULTSTEP && !instanced)
+                        fixedVertices = RESULT.verticesPerFrame;
+
+                    std::printf("%-8s %-10s %7zu %7.3f %12.0f %12.2f %12.1f %12.1f\n", trace.name.c_str(), instanced ? "instanced" : "strip", historyPoints, step,
+                                RESULT.nsPerFrame, RESULT.allocsPerFrame, RESULT.verticesPerFrame, RESULT.damageRectsPerFrame);
+                }
+            }
+
+            params.adaptive   = true;
+            params.instanced  = false;
+            params.bezierStep = DEFAULTSTEP;
+
+            // adaptive is capped at what the step it replaces would use
+            const auto RESULT = replay(trace, params, historyPoints, HISTORYSTEP);
+            std::printf("%-8s %-10s %7zu %7s %12.0f %12.2f %12.1f %12.1f\n", trace.name.c_str(), "adaptive", historyPoints, "-", RESULT.nsPerFrame, RESULT.allocsPerFrame,
+                        RESULT.verticesPerFrame, RESULT.damageRectsPerFrame);
+
+            if (RESULT.verticesPerFrame > fixedVertices) {
+                std::fprintf(stderr, "adaptive uses more vertices than step %.3f: %s, %zu points\n", DEFAULTSTEP, trace.name.c_str(), historyPoints);
+                moreThanFixed = true;
+            }
+        }
+    }
+
+    return moreThanFixed ? 1 : 0;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Above this degree the binomial coefficients in the Bernstein form stop fitting comfortably
+// into a double, so we fall back to de Casteljau.
+constexpr size_t BEZIER_MAX_BERNSTEIN_DEGREE = 256;
+
+/*
+    Evaluates the Bezier curve defined by verts at t.
+
+    Uses the Bernstein form with a Horner scheme, which is O(n) per evaluation and never allocates.
+    For t > 0.5 the curve is evaluated mirrored so the Horner ratio stays <= 1.
+    Curves with a degree above BEZIER_MAX_BERNSTEIN_DEGREE are evaluated with an in-place
+    de Casteljau on scratch, which only allocates if scratch has never been that big.
+
+    V needs public x and y members and a V{x, y} constructor.
+*/
+template <typename V>
+V vecForBezierT(float t, const std::vector<V>& verts, std::vector<V>& scratch) {
+    if (verts.empty())
+        return V{0, 0};
+
+    const size_t DEGREE = verts.size() - 1;
+
+    if (DEGREE == 0)
+        return verts[0];
+
+    if (DEGREE > BEZIER_MAX_BERNSTEIN_DEGREE) {
+        scratch.assign(verts.begin(), verts.end());
+
+        for (size_t level = DEGREE; level > 0; --level) {
+            for (size_t i = 0; i < level; ++i) {
+                scratch[i] = V{scratch[i].x + (scratch[i + 1].x - scratch[i].x) * t, scratch[i].y + (scratch[i + 1].y - scratch[i].y) * t};
+            }
+        }
+
+        return scratch[0];
+    }
+
+    const bool   MIRROR = t > 0.5F;
+    const double S      = MIRROR ? t : 1.0 - t;
+    const double U      = (MIRROR ? 1.0 - t : t) / S;
+
+    // sum C(n, i) * u^i * P_i for i = n..0, binomials derived from C(n, n) = 1 downwards
+    const auto& FIRST = MIRROR ? verts[0] : verts[DEGREE];
+    double      x     = FIRST.x;
+    double      y     = FIRST.y;
+    double      binom = 1.0;
+
+    for (size_t i = DEGREE; i > 0; --i) {
+        binom         = binom * i / (DEGREE - i + 1);
+        const auto& P = MIRROR ? verts[DEGREE - i + 1] : verts[i - 1];
+        x             = x * U + binom * P.x;
+        y             = y * U + binom * P.y;
+    }
+
+    const double SCALE = std::pow(S, (double)DEGREE);
+
+    return V{x * SCALE, y * SCALE};
+}
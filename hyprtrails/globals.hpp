@@ -2,11 +2,42 @@
 
 #include <hyprland/src/plugins/PluginAPI.hpp>
 
+#include "TrailHistory.hpp"
+#include "TrailTicker.hpp"
+
 inline HANDLE PHANDLE = nullptr;
 
+struct STrailShaderLocations {
+    GLint offsetAttrib = -1;
+    GLint ageAttrib    = -1;
+    GLint elapsed      = -1;
+    GLint maxAge       = -1;
+    GLint width        = -1;
+
+    // instanced only
+    GLint samples[4]  = {-1, -1, -1, -1};
+    GLint monitorSize = -1;
+};
+
+// reset every frame, logged with plugin:hyprtrails:debug_stats
+struct STrailStats {
+    size_t uploadedBytes    = 0; // vertex data actually sent to the GPU
+    size_t clientArrayBytes = 0; // what client-side vertex arrays would have copied, once per draw call
+    size_t drawCalls        = 0;
+    size_t rebuiltMeshes    = 0;
+    size_t bezierSamples    = 0; // over all rebuilt meshes
+};
+
 struct SGlobalState {
-    SShader          trailShader;
-    wl_event_source* tick = nullptr;
+    SShader               trailShader;
+    STrailShaderLocations trailLocations;
+    SShader               trailInstancedShader;
+    STrailShaderLocations trailInstancedLocations;
+    STrailStats           stats;
+    UP<CTrailTicker>      ticker;
+
+    // sampled once per frame, every trail computes its ages against this
+    CTrailHistory::clock::time_point frameTime;
 };
 
 inline UP<SGlobalState> g_pGlobalState;
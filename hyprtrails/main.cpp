@@ -73,13 +73,27 @@ GLuint CreateProgram(const std::string& vert, const std::string& frag) {
     return prog;
 }
 
-int onTick(void* data) {
-    EMIT_HOOK_EVENT("trailTick", nullptr);
+void onRenderStage(eRenderStage stage) {
+    static auto* const PDEBUGSTATS = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:debug_stats")->getDataStaticPtr();
 
-    const int TIMEOUT = g_pHyprRenderer->m_mostHzMonitor ? 1000.0 / g_pHyprRenderer->m_mostHzMonitor->m_refreshRate : 16;
-    wl_event_source_timer_update(g_pGlobalState->tick, TIMEOUT);
+    if (stage == RENDER_BEGIN) {
+        g_pGlobalState->stats     = {};
+        g_pGlobalState->frameTime = CTrailHistory::clock::now();
+        return;
+    }
+
+    if (stage != RENDER_POST || !**PDEBUGSTATS)
+        return;
+
+    const auto& STATS = g_pGlobalState->stats;
 
-    return 0;
+    if (STATS.drawCalls == 0)
+        return;
+
+    Debug::log(LOG,
+               "[hyprtrails] frame stats: {} draw calls, uploaded {} bytes of vertex data, client-side arrays would have copied {} bytes, rebuilt {} meshes from {} "
+               "bezier samples",
+               STATS.drawCalls, STATS.uploadedBytes, STATS.clientArrayBytes, STATS.rebuiltMeshes, STATS.bezierSamples);
 }
 
 void initGlobal() {
@@ -92,9 +106,27 @@ void initGlobal() {
     g_pGlobalState->trailShader.uniformLocations[SHADER_COLOR]      = glGetUniformLocation(prog, "color");
     g_pGlobalState->trailShader.uniformLocations[SHADER_POS_ATTRIB] = glGetAttribLocation(prog, "pos");
     g_pGlobalState->trailShader.uniformLocations[SHADER_GRADIENT]   = glGetUniformLocation(prog, "snapshots");
-
-    g_pGlobalState->tick = wl_event_loop_add_timer(g_pCompositor->m_wlEventLoop, &onTick, nullptr);
-    wl_event_source_timer_update(g_pGlobalState->tick, 1);
+    g_pGlobalState->trailLocations.offsetAttrib                     = glGetAttribLocation(prog, "offset");
+    g_pGlobalState->trailLocations.ageAttrib                        = glGetAttribLocation(prog, "age");
+    g_pGlobalState->trailLocations.elapsed                          = glGetUniformLocation(prog, "elapsed");
+    g_pGlobalState->trailLocations.maxAge                           = glGetUniformLocation(prog, "maxAge");
+    g_pGlobalState->trailLocations.width                            = glGetUniformLocation(prog, "width");
+
+    prog                                                                   = CreateProgram(QUADTRAIL_INSTANCED, FRAGTRAIL);
+    g_pGlobalState->trailInstancedShader.program                           = prog;
+    g_pGlobalState->trailInstancedShader.uniformLocations[SHADER_PROJ]     = glGetUniformLocation(prog, "proj");
+    g_pGlobalState->trailInstancedShader.uniformLocations[SHADER_COLOR]    = glGetUniformLocation(prog, "color");
+    g_pGlobalState->trailInstancedShader.uniformLocations[SHADER_GRADIENT] = glGetUniformLocation(prog, "snapshots");
+    g_pGlobalState->trailInstancedLocations.elapsed                        = glGetUniformLocation(prog, "elapsed");
+    g_pGlobalState->trailInstancedLocations.maxAge                         = glGetUniformLocation(prog, "maxAge");
+    g_pGlobalState->trailInstancedLocations.width                          = glGetUniformLocation(prog, "width");
+    g_pGlobalState->trailInstancedLocations.monitorSize                    = glGetUniformLocation(prog, "monitorSize");
+    g_pGlobalState->trailInstancedLocations.samples[0]                     = glGetAttribLocation(prog, "prevSample");
+    g_pGlobalState->trailInstancedLocations.samples[1]                     = glGetAttribLocation(prog, "startSample");
+    g_pGlobalState->trailInstancedLocations.samples[2]                     = glGetAttribLocation(prog, "endSample");
+    g_pGlobalState->trailInstancedLocations.samples[3]                     = glGetAttribLocation(prog, "nextSample");
+
+    g_pGlobalState->ticker = makeUnique<CTrailTicker>();
 }
 
 APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
@@ -110,11 +142,18 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
 
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprtrails:bezier_step", Hyprlang::FLOAT{0.025});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprtrails:points_per_step", Hyprlang::INT{2});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprtrails:adaptive_step", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprtrails:flatness", Hyprlang::FLOAT{0.5});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprtrails:vertex_budget", Hyprlang::INT{8192});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprtrails:history_points", Hyprlang::INT{20});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprtrails:history_step", Hyprlang::INT{2});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprtrails:color", Hyprlang::INT{*configStringToInt("rgba(ffaa00ff)")});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprtrails:gpu_extrude", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprtrails:damage_tolerance", Hyprlang::INT{16});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprtrails:debug_stats", Hyprlang::INT{0});
 
-    static auto P = HyprlandAPI::registerCallbackDynamic(PHANDLE, "openWindow", [&](void* self, SCallbackInfo& info, std::any data) { onNewWindow(self, data); });
+    static auto P  = HyprlandAPI::registerCallbackDynamic(PHANDLE, "openWindow", [&](void* self, SCallbackInfo& info, std::any data) { onNewWindow(self, data); });
+    static auto P2 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "render", [&](void* self, SCallbackInfo& info, std::any data) { onRenderStage(std::any_cast<eRenderStage>(data)); });
 
     g_pGlobalState = makeUnique<SGlobalState>();
     initGlobal();
@@ -135,6 +174,6 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
 }
 
 APICALL EXPORT void PLUGIN_EXIT() {
-    wl_event_source_remove(g_pGlobalState->tick);
+    g_pGlobalState->ticker.reset();
     g_pHyprRenderer->m_renderPass.removeAllOfType("CTrailPassElement");
 }
@@ -7,18 +7,66 @@ inline const std::string QUADTRAIL = R"#(
 precision mediump float;
 uniform mat3 proj;
 uniform vec4 color;
+uniform highp float elapsed;
+uniform highp float maxAge;
+uniform float width;
 in vec2 pos;
+in vec2 offset;
+in highp vec2 age; // age at build time, growth per elapsed
 in vec2 texcoord;
 in vec4 colors;
 out vec4 v_color;
 out vec2 v_texcoord;
 
 void main() {
-    gl_Position = vec4(proj * vec3(pos, 1.0), 1.0);
+    highp float vertAge = age.x + age.y * elapsed;
+    float coeff = width * max(0.0, 1.0 - vertAge / maxAge);
+    gl_Position = vec4(proj * vec3(pos + offset * coeff, 1.0), 1.0);
     v_color = color;
     v_texcoord = texcoord;
 })#";
 
+// plugin:hyprtrails:gpu_extrude. One instance per segment, 4 vertices each.
+// Samples are xy = monitor-normalized center, z = age at build time, w = age growth per elapsed.
+inline const std::string QUADTRAIL_INSTANCED = R"#(
+#version 300 es
+precision highp float;
+uniform mat3 proj;
+uniform vec4 color;
+uniform float elapsed;
+uniform float maxAge;
+uniform float width;
+uniform vec2 monitorSize;
+in vec4 prevSample;
+in vec4 startSample;
+in vec4 endSample;
+in vec4 nextSample;
+out vec4 v_color;
+out vec2 v_texcoord;
+
+void main() {
+    // 0 and 1 are at the start, 2 and 3 at the end of the segment
+    bool atEnd = gl_VertexID >= 2;
+    vec4 s = atEnd ? endSample : startSample;
+
+    // central difference with the neighbors, in px so the normal matches the cpu path
+    vec2 dir = (atEnd ? nextSample.xy - startSample.xy : endSample.xy - prevSample.xy) * monitorSize;
+    float len = length(dir);
+    vec2 n = len > 0.0 ? dir / len : vec2(0.0);
+
+    // rotate by 90 for even, -90 for odd vertices
+    vec2 offset = vec2(-n.y / monitorSize.y, n.x / monitorSize.x);
+    if (gl_VertexID % 2 == 1)
+        offset = -offset;
+
+    float age = s.z + s.w * elapsed;
+    float coeff = width * max(0.0, 1.0 - age / maxAge);
+
+    gl_Position = vec4(proj * vec3(s.xy + offset * coeff, 1.0), 1.0);
+    v_color = color;
+    v_texcoord = s.xy;
+})#";
+
 inline const std::string FRAGTRAIL = R"#(
 #version 300 es
 precision mediump float;
@@ -0,0 +1,185 @@
+// Tests for CTrailHistory, the ring buffer every trail records its window boxes in.
+// Covers wrapping past capacity, the order entries come out in, repacking on setCapacity and entry ages.
+//
+// Usage: hyprtrails-test-history
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "../TrailHistory.hpp"
+
+static int g_failures = 0;
+
+#define CHECK(cond)                                                                                                                                                                \
+    do {                                                                                                                                                                           \
+        if (!(cond)) {                                                                                                                                                             \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);                                                                                          \
+            g_failures++;                                                                                                                                                          \
+        }                                                                                                                                                                          \
+    } while (0)
+
+static const CTrailHistory::clock::time_point EPOCH = {};
+
+// entry n is the box {n, n + 1, n + 2, n + 3}, pushed at EPOCH + n ms
+static void pushEntries(CTrailHistory& history, int from, int to) {
+    for (int n = from; n < to; ++n) {
+        history.push(n, n + 1, n + 2, n + 3, EPOCH + std::chrono::milliseconds(n));
+    }
+}
+
+// every field of every entry, oldest first
+static std::vector<int> entriesOldestFirst(const CTrailHistory& history) {
+    std::vector<int> entries;
+    for (size_t i = history.size(); i-- > 0;) {
+        const int N = history.x(i);
+        CHECK(history.y(i) == N + 1);
+        CHECK(history.w(i) == N + 2);
+        CHECK(history.h(i) == N + 3);
+        CHECK(history.time(i) == EPOCH + std::chrono::milliseconds(N));
+        entries.push_back(N);
+    }
+    return entries;
+}
+
+static std::vector<int> range(int from, int to) {
+    std::vector<int> entries;
+    for (int n = from; n < to; ++n) {
+        entries.push_back(n);
+    }
+    return entries;
+}
+
+static void testEmpty() {
+    CTrailHistory history;
+    CHECK(history.empty());
+    CHECK(history.capacity() == 0);
+
+    // nowhere to put it
+    pushEntries(history, 0, 3);
+    CHECK(history.empty());
+
+    history.setCapacity(4);
+    CHECK(history.empty());
+    CHECK(!history.full());
+}
+
+static void testWraparound() {
+    CTrailHistory history;
+    history.setCapacity(4);
+
+    pushEntries(history, 0, 3);
+    CHECK(history.size() == 3);
+    CHECK(!history.full());
+    CHECK(entriesOldestFirst(history) == range(0, 3));
+
+    // the fifth push overwrites the first entry, the rest go around again
+    pushEntries(history, 3, 11);
+    CHECK(history.size() == 4);
+    CHECK(history.full());
+    CHECK(history.x(0) == 10);
+    CHECK(history.x(3) == 7);
+    CHECK(entriesOldestFirst(history) == range(7, 11));
+
+    history.clear();
+    CHECK(history.empty());
+    pushEntries(history, 20, 22);
+    CHECK(entriesOldestFirst(history) == range(20, 22));
+}
+
+static void testShrinkWrapped() {
+    CTrailHistory history;
+    history.setCapacity(5);
+    pushEntries(history, 0, 8);
+
+    // keeps the newest ones
+    history.setCapacity(3);
+    CHECK(history.capacity() == 3);
+    CHECK(history.size() == 3);
+    CHECK(entriesOldestFirst(history) == range(5, 8));
+
+    pushEntries(history, 8, 10);
+    CHECK(entriesOldestFirst(history) == range(7, 10));
+}
+
+static void testGrowWrapped() {
+    CTrailHistory history;
+    history.setCapacity(3);
+    pushEntries(history, 0, 5);
+
+    // keeps everything and has room for more
+    history.setCapacity(6);
+    CHECK(history.capacity() == 6);
+    CHECK(history.size() == 3);
+    CHECK(!history.full());
+    CHECK(entriesOldestFirst(history) == range(2, 5));
+
+    pushEntries(history, 5, 8);
+    CHECK(history.full());
+    CHECK(entriesOldestFirst(history) == range(2, 8));
+
+    pushEntries(history, 8, 10);
+    CHECK(entriesOldestFirst(history) == range(4, 10));
+}
+
+static void testShrinkToZero() {
+    CTrailHistory history;
+    history.setCapacity(3);
+    pushEntries(history, 0, 5);
+
+    history.setCapacity(0);
+    CHECK(history.empty());
+
+    pushEntries(history, 5, 6);
+    CHECK(history.empty());
+}
+
+static void testAges() {
+    CTrailHistory history;
+    history.setCapacity(4);
+    pushEntries(history, 0, 3);
+
+    const auto NOW = EPOCH + std::chrono::milliseconds(10);
+    CHECK(history.ageMs(0, NOW) == 8.F);
+    CHECK(history.ageMs(2, NOW) == 10.F);
+
+    // entries 5 to 8 are left, the newest in the last slot so reading them wraps around
+    pushEntries(history, 3, 9);
+    CHECK(history.ageMs(0, NOW) == 2.F);
+    CHECK(history.ageMs(3, NOW) == 5.F);
+    CHECK(history.ageMs(0, EPOCH + std::chrono::microseconds(8500)) == 0.5F);
+}
+
+static void testAgeBeforeEntry() {
+    const auto THEN = EPOCH + std::chrono::milliseconds(10);
+
+    // a now from before the entry was pushed clamps to 0
+    const float AGE = CTrailHistory::ageMsBetween(THEN, EPOCH);
+    CHECK(AGE == 0.F);
+    CHECK(!std::signbit(AGE));
+    CHECK(!std::isnan(AGE));
+    CHECK(CTrailHistory::ageMsBetween(THEN, THEN) == 0.F);
+
+    CTrailHistory history;
+    history.setCapacity(2);
+    pushEntries(history, 5, 7);
+    CHECK(history.ageMs(0, EPOCH) == 0.F);
+    CHECK(history.ageMs(1, EPOCH) == 0.F);
+}
+
+int main() {
+    testEmpty();
+    testWraparound();
+    testShrinkWrapped();
+    testGrowWrapped();
+    testShrinkToZero();
+    testAges();
+    testAgeBeforeEntry();
+
+    if (g_failures)
+        std::fprintf(stderr, "%d checks failed\n", g_failures);
+    else
+        std::printf("all checks passed\n");
+
+    return g_failures ? 1 : 0;
+}
@@ -1,13 +1,25 @@
 #include "trail.hpp"
 
+#include <algorithm>
+#include <span>
+
 #include <hyprland/src/Compositor.hpp>
 #include <hyprland/src/desktop/Window.hpp>
 #include <hyprland/src/render/Renderer.hpp>
 
 #include "globals.hpp"
 #include "TrailPassElement.hpp"
+#include "TrailTicker.hpp"
+
+// width of the trail head, in logical px
+constexpr float TRAIL_WIDTH = 50;
+
+static box windowBox(PHLWINDOW pWindow) {
+    return box{(float)pWindow->m_realPosition->value().x, (float)pWindow->m_realPosition->value().y, (float)pWindow->m_realSize->value().x,
+               (float)pWindow->m_realSize->value().y};
+}
 
-void CTrail::onTick() {
+bool CTrail::onTick() {
     static auto* const PHISTORYSTEP   = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:history_step")->getDataStaticPtr();
     static auto* const PHISTORYPOINTS = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:history_points")->getDataStaticPtr();
 
@@ -15,32 +27,60 @@ void CTrail::onTick() {
 
     const auto PWINDOW = m_pWindow.lock();
 
+    if (!PWINDOW)
+        return false;
+
+    const box CURRENT = windowBox(PWINDOW);
+
     if (m_iTimer > **PHISTORYSTEP) {
-        m_dLastGeoms.push_front({box{(float)PWINDOW->m_realPosition->value().x, (float)PWINDOW->m_realPosition->value().y, (float)PWINDOW->m_realSize->value().x,
-                                     (float)PWINDOW->m_realSize->value().y},
-                                 std::chrono::system_clock::now()});
-        while (m_dLastGeoms.size() > **PHISTORYPOINTS)
-            m_dLastGeoms.pop_back();
+        m_history.setCapacity(std::max<Hyprlang::INT>(**PHISTORYPOINTS, 0));
+        m_history.push(CURRENT.x, CURRENT.y, CURRENT.w, CURRENT.h, CTrailHistory::clock::now());
 
         m_iTimer = 0;
+        m_iGeneration++;
     }
 
-    if (m_bNeedsDamage) {
-        g_pHyprRenderer->damageBox(m_bLastBox);
-        m_bNeedsDamage = false;
+    // damage what we drew last frame and the frame before, so a tail that shrank since still gets cleared
+    if (!m_rDrawnDamage.empty() || !m_rLastDamage.empty()) {
+        g_pHyprRenderer->damageRegion(m_rDrawnDamage.copy().add(m_rLastDamage));
+        m_rLastDamage = m_rDrawnDamage;
+        m_rDrawnDamage.clear();
+        return true;
     }
+
+    // once the whole history caught up with the window there is nothing left to draw
+    return !m_history.full() || !m_history.allEqual(CURRENT.x, CURRENT.y, CURRENT.w, CURRENT.h);
+}
+
+void CTrail::wake() {
+    if (m_bTickActive || !g_pGlobalState || !g_pGlobalState->ticker)
+        return;
+
+    // we stopped recording while idle, so the whole history is the resting box. Make it recent again
+    // so the trail of the next move fades like it would have without the break.
+    m_history.restamp(CTrailHistory::clock::now());
+
+    m_iGeneration++;
+    g_pGlobalState->ticker->add(this);
 }
 
 CTrail::CTrail(PHLWINDOW pWindow) : IHyprWindowDecoration(pWindow), m_pWindow(pWindow) {
     m_lastWindowPos  = pWindow->m_realPosition->value();
     m_lastWindowSize = pWindow->m_realSize->value();
 
-    pTickCb = HyprlandAPI::registerCallbackDynamic(PHANDLE, "trailTick", [this](void* self, SCallbackInfo& info, std::any data) { this->onTick(); });
+    wake();
 }
 
 CTrail::~CTrail() {
     damageEntire();
-    HyprlandAPI::unregisterCallback(PHANDLE, pTickCb);
+
+    if (g_pGlobalState && g_pGlobalState->ticker)
+        g_pGlobalState->ticker->remove(this);
+
+    g_pHyprRenderer->makeEGLCurrent();
+    for (auto& [id, mesh] : m_mMeshes) {
+        destroyMesh(mesh);
+    }
 }
 
 SDecorationPositioningInfo CTrail::getPositioningInfo() {
@@ -61,25 +101,6 @@ void scaleBox2(box& box, float coeff) {
     box.y += hhl;
 }
 
-Vector2D vecForT(const Vector2D& a, const Vector2D& b, const float& t) {
-    const Vector2D vec_PQ = b - a;
-    return Vector2D{a + vec_PQ * t};
-}
-
-Vector2D vecForBezierT(const float& t, const std::vector<Vector2D>& verts) {
-    std::vector<Vector2D> pts;
-
-    for (size_t vertexIndex = 0; vertexIndex < verts.size() - 1; vertexIndex++) {
-        Vector2D p = verts[vertexIndex];
-        pts.push_back(vecForT(p, verts[vertexIndex + 1], t));
-    }
-
-    if (pts.size() > 1)
-        return vecForBezierT(t, pts);
-    else
-        return pts[0];
-}
-
 void CTrail::draw(PHLMONITOR pMonitor, const float& a) {
     if (!validMapped(m_pWindow))
         return;
@@ -89,173 +110,204 @@ void CTrail::draw(PHLMONITOR pMonitor, const float& a) {
     if (!PWINDOW->m_windowData.decorate.valueOrDefault())
         return;
 
+    // the window might have started moving without us being told
+    if (!m_bTickActive && !m_history.empty() && historyBox(0) != windowBox(PWINDOW))
+        wake();
+
+    pruneMeshes();
+
+    if (m_history.size() < 2 || meshFor(pMonitor, PWINDOW->middle() - pMonitor->m_position).empty())
+        return;
+
     auto data = CTrailPassElement::STrailData{this, a};
     g_pHyprRenderer->m_renderPass.add(makeUnique<CTrailPassElement>(data));
 }
 
-void CTrail::renderPass(PHLMONITOR pMonitor, const float& a) {
-    const auto         PWINDOW = m_pWindow.lock();
-
-    static auto* const PBEZIERSTEP    = (Hyprlang::FLOAT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:bezier_step")->getDataStaticPtr();
-    static auto* const PPOINTSPERSTEP = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:points_per_step")->getDataStaticPtr();
-    static auto* const PCOLOR         = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:color")->getDataStaticPtr();
+box CTrail::historyBox(size_t i) const {
+    return box{m_history.x(i), m_history.y(i), m_history.w(i), m_history.h(i)};
+}
 
-    const CHyprColor   COLOR = **PCOLOR;
+void CTrail::rebuildMesh(STrailMesh& mesh, PHLMONITOR pMonitor, const Vector2D& windowMiddle, CTrailHistory::clock::time_point now, bool instanced) {
+    static auto* const PBEZIERSTEP      = (Hyprlang::FLOAT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:bezier_step")->getDataStaticPtr();
+    static auto* const PPOINTSPERSTEP   = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:points_per_step")->getDataStaticPtr();
+    static auto* const PDAMAGETOLERANCE = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:damage_tolerance")->getDataStaticPtr();
+    static auto* const PADAPTIVESTEP    = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:adaptive_step")->getDataStaticPtr();
+    static auto* const PFLATNESS        = (Hyprlang::FLOAT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:flatness")->getDataStaticPtr();
+    static auto* const PVERTEXBUDGET    = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:vertex_budget")->getDataStaticPtr();
+    static auto* const PDEBUGSTATS      = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:debug_stats")->getDataStaticPtr();
+
+    mesh.generation   = m_iGeneration;
+    mesh.monitor      = pMonitor;
+    mesh.windowMiddle = windowMiddle;
+    mesh.monitorPos   = pMonitor->m_position;
+    mesh.monitorSize  = pMonitor->m_size;
+    mesh.monitorScale = pMonitor->m_scale;
+    mesh.builtAt      = now;
+    mesh.instanced    = instanced;
+    mesh.uploaded     = false;
+
+    STrailGeometryParams params;
+    params.windowMiddle    = {windowMiddle.x, windowMiddle.y};
+    params.monitorPos      = {pMonitor->m_position.x, pMonitor->m_position.y};
+    params.monitorSize     = {pMonitor->m_size.x, pMonitor->m_size.y};
+    params.monitorScale    = pMonitor->m_scale;
+    params.now             = now;
+    params.width           = TRAIL_WIDTH;
+    params.instanced       = instanced;
+    params.bezierStep      = **PBEZIERSTEP;
+    params.pointsPerStep   = **PPOINTSPERSTEP;
+    params.adaptive        = **PADAPTIVESTEP;
+    params.flatness        = **PFLATNESS;
+    params.damageTolerance = std::max<Hyprlang::INT>(**PDAMAGETOLERANCE, 0);
+
+    // every moving trail gets an equal share of the budget for each mesh it builds, so one on two monitors uses its share twice
+    const size_t ACTIVE = std::max<size_t>(g_pGlobalState->ticker ? g_pGlobalState->ticker->activeCount() : 1, 1);
+    const size_t SHARE  = std::max<Hyprlang::INT>(**PVERTEXBUDGET, 0) / ACTIVE;
+    params.maxSamples   = instanced ? (SHARE > 3 ? SHARE - 3 : 0) : (SHARE > 4 ? (SHARE - 4) / 2 : 0);
+
+    buildTrailGeometry(m_history, params, mesh.geometry, m_geometryScratch);
+
+    mesh.damage.clear();
+    for (const auto& RECT : mesh.geometry.damage) {
+        mesh.damage.add(CBox{RECT.x, RECT.y, RECT.w, RECT.h});
+    }
 
-    if (m_dLastGeoms.size() < 2)
+    if (mesh.geometry.bezierSamples == 0)
         return;
 
-    box thisbox =
-        box{(float)PWINDOW->m_realPosition->value().x, (float)PWINDOW->m_realPosition->value().y, (float)PWINDOW->m_realSize->value().x, (float)PWINDOW->m_realSize->value().y};
-    CBox wlrbox = {thisbox.x - pMonitor->m_position.x, thisbox.y - pMonitor->m_position.y, thisbox.w, thisbox.h};
-    wlrbox.scale(pMonitor->m_scale).round();
+    g_pGlobalState->stats.rebuiltMeshes++;
+    g_pGlobalState->stats.bezierSamples += mesh.geometry.bezierSamples;
 
-    g_pHyprOpenGL->scissor(nullptr); // allow the entire window and stencil to render
-    glClearStencil(0);
-    glClear(GL_STENCIL_BUFFER_BIT);
+    if (params.adaptive && **PDEBUGSTATS)
+        Debug::log(LOG, "[hyprtrails] adaptive step: {} samples from {} history points at scale {}, capped at {} for {} active trails", mesh.geometry.bezierSamples,
+                   m_history.size(), pMonitor->m_scale, params.maxSamples, ACTIVE);
+}
 
-    g_pHyprOpenGL->setCapStatus(GL_STENCIL_TEST, true);
+CTrail::STrailMesh& CTrail::meshFor(PHLMONITOR pMonitor, const Vector2D& windowMiddle) {
+    static auto* const PGPUEXTRUDE = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:gpu_extrude")->getDataStaticPtr();
 
-    glStencilFunc(GL_ALWAYS, 1, -1);
-    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+    const bool         INSTANCED = **PGPUEXTRUDE;
 
-    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-    g_pHyprOpenGL->renderRect(wlrbox, CHyprColor(0, 0, 0, 0), {.round = PWINDOW->rounding() * pMonitor->m_scale, .roundingPower = PWINDOW->roundingPower()});
-    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    auto&              mesh = m_mMeshes[pMonitor->m_id];
 
-    glStencilFunc(GL_NOTEQUAL, 1, -1);
-    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+    if (mesh.generation != m_iGeneration || mesh.windowMiddle != windowMiddle || mesh.monitorPos != pMonitor->m_position || mesh.monitorSize != pMonitor->m_size ||
+        mesh.monitorScale != pMonitor->m_scale || mesh.instanced != INSTANCED)
+        rebuildMesh(mesh, pMonitor, windowMiddle, g_pGlobalState->frameTime, INSTANCED);
 
-    CBox   monbox = {0, 0, g_pHyprOpenGL->m_renderData.pMonitor->m_transformedSize.x, g_pHyprOpenGL->m_renderData.pMonitor->m_transformedSize.y};
+    return mesh;
+}
 
-    Mat3x3 matrix   = g_pHyprOpenGL->m_renderData.monitorProjection.projectBox(monbox, wlTransformToHyprutils(invertTransform(WL_OUTPUT_TRANSFORM_NORMAL)), monbox.rot);
-    Mat3x3 glMatrix = g_pHyprOpenGL->m_renderData.projection.copy().multiply(matrix);
+// meshes of unplugged monitors would otherwise hold on to their buffers for as long as the window lives
+void CTrail::pruneMeshes() {
+    std::erase_if(m_mMeshes, [](auto& entry) {
+        if (!entry.second.monitor.expired())
+            return false;
 
-    g_pHyprOpenGL->blend(true);
+        destroyMesh(entry.second);
+        return true;
+    });
+}
 
-    glUseProgram(g_pGlobalState->trailShader.program);
+void CTrail::destroyMesh(STrailMesh& mesh) {
+    if (mesh.vao)
+        glDeleteVertexArrays(1, &mesh.vao);
+    if (mesh.vbo)
+        glDeleteBuffers(1, &mesh.vbo);
 
-    glMatrix.transpose();
-    g_pGlobalState->trailShader.setUniformMatrix3fv(SHADER_PROJ, 1, GL_FALSE, glMatrix.getMatrix());
+    mesh.vao = 0;
+    mesh.vbo = 0;
+}
 
-    std::vector<point2>   points;
-    std::vector<Vector2D> bezierPts;
-    std::vector<Vector2D> pointsForBezier;
-    std::vector<float>    agesForBezier;
+void CTrail::bindMesh(STrailMesh& mesh) {
+    // the layout differs between modes
+    if (mesh.vao && mesh.vaoInstanced != mesh.instanced) {
+        glDeleteVertexArrays(1, &mesh.vao);
+        mesh.vao = 0;
+    }
 
-    float                 originalCoeff = 50;
+    if (!mesh.vbo)
+        glGenBuffers(1, &mesh.vbo);
 
-    auto                  msFrom = [](std::chrono::system_clock::time_point t) -> float {
-        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now() - t).count() / 1000.0;
-    };
+    if (!mesh.vao) {
+        glGenVertexArrays(1, &mesh.vao);
 
-    auto dist = [&](const point2& a, const point2& b) -> float {
-        Vector2D diff = Vector2D{a.x - b.x, a.y - b.y} * pMonitor->m_size;
-        return std::sqrt(diff.x * diff.x + diff.y * diff.y);
-    };
+        glBindVertexArray(mesh.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
 
-    float    msMaxToLast = msFrom(m_dLastGeoms.back().second);
+        if (mesh.instanced) {
+            // every instance is one segment, and reads the 4 samples around it
+            for (size_t i = 0; i < 4; ++i) {
+                const GLint LOC = g_pGlobalState->trailInstancedLocations.samples[i];
+                glVertexAttribPointer(LOC, 4, GL_FLOAT, GL_FALSE, sizeof(STrailSample), (void*)(i * sizeof(STrailSample)));
+                glVertexAttribDivisor(LOC, 1);
+                glEnableVertexAttribArray(LOC);
+            }
+        } else {
+            glVertexAttribPointer(g_pGlobalState->trailShader.uniformLocations[SHADER_POS_ATTRIB], 2, GL_FLOAT, GL_FALSE, sizeof(STrailVertex), (void*)offsetof(STrailVertex, pos));
+            glVertexAttribPointer(g_pGlobalState->trailLocations.offsetAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(STrailVertex), (void*)offsetof(STrailVertex, offset));
+            glVertexAttribPointer(g_pGlobalState->trailLocations.ageAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(STrailVertex), (void*)offsetof(STrailVertex, age));
+
+            glEnableVertexAttribArray(g_pGlobalState->trailShader.uniformLocations[SHADER_POS_ATTRIB]);
+            glEnableVertexAttribArray(g_pGlobalState->trailLocations.offsetAttrib);
+            glEnableVertexAttribArray(g_pGlobalState->trailLocations.ageAttrib);
+        }
 
-    float    dists[2] = {0, 0};
+        mesh.vaoInstanced = mesh.instanced;
+    } else
+        glBindVertexArray(mesh.vao);
 
-    Vector2D mainVec      = {originalCoeff / pMonitor->m_size.x, originalCoeff / pMonitor->m_size.y};
-    Vector2D windowMiddle = PWINDOW->middle() - pMonitor->m_position;
+    if (!mesh.uploaded) {
+        const size_t BYTES = mesh.bytes();
+        const void*  DATA  = mesh.instanced ? (const void*)mesh.geometry.samples.data() : (const void*)mesh.geometry.vertices.data();
 
-    points.push_back(
-        Vector2D{cos(0) * mainVec.x - sin(0) * mainVec.y + windowMiddle.x / pMonitor->m_size.x, sin(0) * mainVec.x + cos(0) * mainVec.y + windowMiddle.y / pMonitor->m_size.y});
-    points.push_back(Vector2D{cos(-M_PI_2) * mainVec.x - sin(-M_PI_2) * mainVec.y + windowMiddle.x / pMonitor->m_size.x,
-                              sin(-M_PI_2) * mainVec.x + cos(-M_PI_2) * mainVec.y + windowMiddle.y / pMonitor->m_size.y});
-    points.push_back(Vector2D{cos(M_PI_2) * mainVec.x - sin(M_PI_2) * mainVec.y + windowMiddle.x / pMonitor->m_size.x,
-                              sin(M_PI_2) * mainVec.x + cos(M_PI_2) * mainVec.y + windowMiddle.y / pMonitor->m_size.y});
-    points.push_back(Vector2D{cos(M_PI) * mainVec.x - sin(M_PI) * mainVec.y + windowMiddle.x / pMonitor->m_size.x,
-                              sin(M_PI) * mainVec.x + cos(M_PI) * mainVec.y + windowMiddle.y / pMonitor->m_size.y});
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+        // orphan the old storage, so we don't wait for draws from last frame still reading it
+        glBufferData(GL_ARRAY_BUFFER, BYTES, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, BYTES, DATA);
+        mesh.uploaded = true;
 
-    pointsForBezier.push_back(windowMiddle);
-    agesForBezier.push_back(0);
+        g_pGlobalState->stats.uploadedBytes += BYTES;
+    }
 
-    for (size_t i = 0; i < m_dLastGeoms.size(); i += 1) {
-        box box = m_dLastGeoms[i].first;
-        box.x -= pMonitor->m_position.x;
-        box.y -= pMonitor->m_position.y;
-        Vector2D middle = {box.x + box.w / 2.0, box.y + box.h / 2.0};
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
 
-        if (middle == pointsForBezier[pointsForBezier.size() - 1])
-            continue;
+void CTrail::drawMesh(const STrailMesh& mesh) {
+    if (mesh.instanced)
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, mesh.geometry.samples.size() - 3);
+    else
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, mesh.geometry.vertices.size());
 
-        pointsForBezier.push_back(middle);
-        agesForBezier.push_back(msFrom(m_dLastGeoms[i].second));
-    }
+    g_pGlobalState->stats.drawCalls++;
+}
 
-    if (pointsForBezier.size() < 3) {
-        glClearStencil(0);
-        glClear(GL_STENCIL_BUFFER_BIT);
-        g_pHyprOpenGL->setCapStatus(GL_STENCIL_TEST, false);
+void CTrail::renderMask(PHLMONITOR pMonitor) {
+    const auto PWINDOW = m_pWindow.lock();
 
-        glStencilMask(-1);
-        glStencilFunc(GL_ALWAYS, 1, 0xFF);
-        g_pHyprOpenGL->scissor(nullptr);
-        return;
-    }
+    box        thisbox = windowBox(PWINDOW);
+    CBox       wlrbox  = {thisbox.x - pMonitor->m_position.x, thisbox.y - pMonitor->m_position.y, thisbox.w, thisbox.h};
+    wlrbox.scale(pMonitor->m_scale).round();
 
-    float maxAge          = agesForBezier.back();
-    float tCoeff          = **PBEZIERSTEP;
-    int   pointsPerBezier = **PPOINTSPERSTEP;
-    bezierPts.push_back(vecForBezierT(0, pointsForBezier));
-    for (float t = tCoeff; t <= 1.0; t += tCoeff) {
-        bezierPts.push_back(vecForBezierT(t, pointsForBezier));
-
-        const Vector2D& lastbezier     = bezierPts.back();
-        const Vector2D& lastprevbezier = bezierPts[bezierPts.size() - 2];
-
-        for (size_t i = 1; i < pointsPerBezier + 1; ++i) {
-            const float     bezierPointStep = (1.0 / (pointsPerBezier + 2));
-            const Vector2D& middle          = vecForT(lastprevbezier, lastbezier, bezierPointStep * (i + 1));
-            const Vector2D& lastmiddle      = vecForT(lastprevbezier, lastbezier, bezierPointStep * i);
-
-            Vector2D        vecNormal = {middle.x - lastmiddle.x, middle.y - lastmiddle.y};
-
-            // normalize vec
-            float invlen = 1.0 / std::sqrt(vecNormal.x * vecNormal.x + vecNormal.y * vecNormal.y);
-            vecNormal.x *= invlen;
-            vecNormal.y *= invlen;
-
-            // make sure it points up
-            // vecNormal.y = std::abs(vecNormal.y);
-
-            // extend by coeff
-            float ageCoeff = t * (agesForBezier.size() - 1);
-            float ageFloor = std::floor(ageCoeff);
-            float ageCeil  = std::ceil(ageCoeff);
-            float approxAge =
-                agesForBezier[static_cast<int>(ageFloor)] + (agesForBezier[static_cast<int>(ageCeil)] - agesForBezier[static_cast<int>(ageFloor)]) * (ageCoeff - ageFloor);
-            float    coeff  = originalCoeff * (1.0 - (approxAge / maxAge));
-            Vector2D newVec = {vecNormal.x * coeff / pMonitor->m_size.x, vecNormal.y * coeff / pMonitor->m_size.y};
-
-            if ((newVec.x == 0 && newVec.y == 0) || std::isnan(newVec.x) || std::isnan(newVec.y))
-                continue;
+    g_pHyprOpenGL->renderRect(wlrbox, CHyprColor(0, 0, 0, 0), {.round = PWINDOW->rounding() * pMonitor->m_scale, .roundingPower = PWINDOW->roundingPower()});
+}
 
-            // rotate by 90 and -90 and add middle
-            points.push_back(Vector2D{cos(M_PI_2) * newVec.x - sin(M_PI_2) * newVec.y + middle.x / pMonitor->m_size.x,
-                                      sin(M_PI_2) * newVec.x + cos(M_PI_2) * newVec.y + middle.y / pMonitor->m_size.y});
-            points.push_back(Vector2D{cos(-M_PI_2) * newVec.x - sin(-M_PI_2) * newVec.y + middle.x / pMonitor->m_size.x,
-                                      sin(-M_PI_2) * newVec.x + cos(-M_PI_2) * newVec.y + middle.y / pMonitor->m_size.y});
-        }
-    }
+void CTrail::renderStrip(PHLMONITOR pMonitor, STrailMesh& mesh, SShader& shader, const STrailShaderLocations& locations) {
+    const auto PWINDOW = m_pWindow.lock();
 
-    box thisboxopengl =
+    box        thisboxopengl =
         box{(PWINDOW->m_realPosition->value().x - pMonitor->m_position.x) / pMonitor->m_size.x, (PWINDOW->m_realPosition->value().y - pMonitor->m_position.y) / pMonitor->m_size.y,
             (PWINDOW->m_realPosition->value().x + PWINDOW->m_realSize->value().x) / pMonitor->m_size.x,
             (PWINDOW->m_realPosition->value().y + PWINDOW->m_realSize->value().y) / pMonitor->m_size.y};
-    glUniform4f(g_pGlobalState->trailShader.uniformLocations[SHADER_GRADIENT], thisboxopengl.x, thisboxopengl.y, thisboxopengl.w, thisboxopengl.h);
-    glUniform4f(g_pGlobalState->trailShader.uniformLocations[SHADER_COLOR], COLOR.r, COLOR.g, COLOR.b, COLOR.a);
+    glUniform4f(shader.uniformLocations[SHADER_GRADIENT], thisboxopengl.x, thisboxopengl.y, thisboxopengl.w, thisboxopengl.h);
 
-    CBox transformedBox = monbox;
-    transformedBox.transform(wlTransformToHyprutils(invertTransform(g_pHyprOpenGL->m_renderData.pMonitor->m_transform)), g_pHyprOpenGL->m_renderData.pMonitor->m_transformedSize.x,
-                             g_pHyprOpenGL->m_renderData.pMonitor->m_transformedSize.y);
+    // only the widths change while the mesh is cached
+    const float ELAPSED = CTrailHistory::ageMsBetween(mesh.builtAt, g_pGlobalState->frameTime);
+    glUniform1f(locations.elapsed, ELAPSED);
+    glUniform1f(locations.maxAge, mesh.geometry.maxAge + ELAPSED);
 
-    glVertexAttribPointer(g_pGlobalState->trailShader.uniformLocations[SHADER_POS_ATTRIB], 2, GL_FLOAT, GL_FALSE, 0, (float*)points.data());
+    bindMesh(mesh);
 
-    glEnableVertexAttribArray(g_pGlobalState->trailShader.uniformLocations[SHADER_POS_ATTRIB]);
+    const size_t DRAWSBEFORE = g_pGlobalState->stats.drawCalls;
 
     if (g_pHyprOpenGL->m_renderData.clipBox.width != 0 && g_pHyprOpenGL->m_renderData.clipBox.height != 0) {
         CRegion damageClip{g_pHyprOpenGL->m_renderData.clipBox.x, g_pHyprOpenGL->m_renderData.clipBox.y, g_pHyprOpenGL->m_renderData.clipBox.width,
@@ -265,55 +317,97 @@ void CTrail::renderPass(PHLMONITOR pMonitor, const float& a) {
         if (!damageClip.empty()) {
             for (auto& RECT : damageClip.getRects()) {
                 g_pHyprOpenGL->scissor(&RECT);
-                glDrawArrays(GL_TRIANGLE_STRIP, 0, points.size());
+                drawMesh(mesh);
             }
         }
     } else {
         for (auto& RECT : g_pHyprOpenGL->m_renderData.damage.getRects()) {
             g_pHyprOpenGL->scissor(&RECT);
-            glDrawArrays(GL_TRIANGLE_STRIP, 0, points.size());
+            drawMesh(mesh);
         }
     }
 
-    glDisableVertexAttribArray(g_pGlobalState->trailShader.uniformLocations[SHADER_POS_ATTRIB]);
-
-    glClearStencil(0);
-    glClear(GL_STENCIL_BUFFER_BIT);
-    g_pHyprOpenGL->setCapStatus(GL_STENCIL_TEST, false);
-
-    glStencilMask(-1);
-    glStencilFunc(GL_ALWAYS, 1, 0xFF);
-    g_pHyprOpenGL->scissor(nullptr);
-
-    // calculate damage
-    float minX = 9999999;
-    float minY = 9999999;
-    float maxX = -9999999;
-    float maxY = -9999999;
-
-    for (auto& p : points) {
-        if (p.x < minX)
-            minX = p.x;
-        if (p.y < minY)
-            minY = p.y;
-        if (p.x > maxX)
-            maxX = p.x;
-        if (p.y > maxY)
-            maxY = p.y;
-    }
+    g_pGlobalState->stats.clientArrayBytes += (g_pGlobalState->stats.drawCalls - DRAWSBEFORE) * mesh.bytes();
+
+    m_rDrawnDamage.add(mesh.damage);
+}
+
+void CTrail::renderBatch(PHLMONITOR pMonitor, std::span<CTrail* const> trails) {
+    static auto* const PCOLOR = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprtrails:color")->getDataStaticPtr();
+
+    const CHyprColor   COLOR = **PCOLOR;
 
-    // bring back to global coords
-    minX *= pMonitor->m_size.x;
-    minY *= pMonitor->m_size.y;
-    maxX *= pMonitor->m_size.x;
-    maxY *= pMonitor->m_size.y;
+    // every trail gets its own stencil value, which both masks its window and keeps its strip from blending over itself
+    constexpr size_t MAXSTENCILIDS = 255;
+
+    CBox             monbox = {0, 0, g_pHyprOpenGL->m_renderData.pMonitor->m_transformedSize.x, g_pHyprOpenGL->m_renderData.pMonitor->m_transformedSize.y};
+
+    Mat3x3           matrix   = g_pHyprOpenGL->m_renderData.monitorProjection.projectBox(monbox, wlTransformToHyprutils(invertTransform(WL_OUTPUT_TRANSFORM_NORMAL)), monbox.rot);
+    Mat3x3           glMatrix = g_pHyprOpenGL->m_renderData.projection.copy().multiply(matrix);
+    glMatrix.transpose();
 
-    m_bLastBox.x      = minX + pMonitor->m_position.x;
-    m_bLastBox.y      = minY + pMonitor->m_position.y;
-    m_bLastBox.width  = maxX - minX;
-    m_bLastBox.height = maxY - minY;
+    for (size_t chunk = 0; chunk < trails.size(); chunk += MAXSTENCILIDS) {
+        const auto CHUNK = trails.subspan(chunk, std::min(MAXSTENCILIDS, trails.size() - chunk));
 
-    m_bNeedsDamage = true;
+        g_pHyprOpenGL->scissor(nullptr); // allow the entire window and stencil to render
+        glClearStencil(0);
+        glClear(GL_STENCIL_BUFFER_BIT);
+
+        g_pHyprOpenGL->setCapStatus(GL_STENCIL_TEST, true);
+
+        glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        for (size_t i = 0; i < CHUNK.size(); ++i) {
+            if (!validMapped(CHUNK[i]->m_pWindow))
+                continue;
+
+            glStencilFunc(GL_ALWAYS, i + 1, -1);
+            CHUNK[i]->renderMask(pMonitor);
+        }
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+        g_pHyprOpenGL->blend(true);
+
+        SShader* boundShader = nullptr;
+
+        for (size_t i = 0; i < CHUNK.size(); ++i) {
+            if (!validMapped(CHUNK[i]->m_pWindow))
+                continue;
+
+            auto& mesh = CHUNK[i]->meshFor(pMonitor, CHUNK[i]->m_pWindow.lock()->middle() - pMonitor->m_position);
+
+            if (mesh.empty())
+                continue;
+
+            auto& shader    = mesh.instanced ? g_pGlobalState->trailInstancedShader : g_pGlobalState->trailShader;
+            auto& locations = mesh.instanced ? g_pGlobalState->trailInstancedLocations : g_pGlobalState->trailLocations;
+
+            if (boundShader != &shader) {
+                glUseProgram(shader.program);
+                shader.setUniformMatrix3fv(SHADER_PROJ, 1, GL_FALSE, glMatrix.getMatrix());
+                glUniform4f(shader.uniformLocations[SHADER_COLOR], COLOR.r, COLOR.g, COLOR.b, COLOR.a);
+                glUniform1f(locations.width, TRAIL_WIDTH);
+                glUniform2f(locations.monitorSize, pMonitor->m_size.x, pMonitor->m_size.y);
+                boundShader = &shader;
+            }
+
+            // a strip that crosses another trailing window overwrites its value there, so that
+            // window's own trail could show over it. Rare and short-lived enough to not be worth a clear per trail.
+            glStencilFunc(GL_NOTEQUAL, i + 1, -1);
+            CHUNK[i]->renderStrip(pMonitor, mesh, shader, locations);
+        }
+
+        glBindVertexArray(0);
+
+        glClearStencil(0);
+        glClear(GL_STENCIL_BUFFER_BIT);
+        g_pHyprOpenGL->setCapStatus(GL_STENCIL_TEST, false);
+
+        glStencilMask(-1);
+        glStencilFunc(GL_ALWAYS, 1, 0xFF);
+        g_pHyprOpenGL->scissor(nullptr);
+    }
 }
 
 eDecorationType CTrail::getDecorationType() {
@@ -328,6 +422,9 @@ void CTrail::updateWindow(PHLWINDOW pWindow) {
     m_lastWindowPos  = pWindow->m_realPosition->value() + WORKSPACEOFFSET;
     m_lastWindowSize = pWindow->m_realSize->value();
 
+    // moved or resized, start recording again
+    wake();
+
     damageEntire();
 }
 
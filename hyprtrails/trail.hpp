@@ -2,30 +2,25 @@
 
 #define WLR_USE_UNSTABLE
 
-#include <deque>
+#include <span>
+#include <unordered_map>
 #include <hyprland/src/plugins/PluginAPI.hpp>
 #include <hyprland/src/render/decorations/IHyprWindowDecoration.hpp>
 
+#include "TrailGeometry.hpp"
+#include "TrailHistory.hpp"
+
+struct STrailShaderLocations;
+
 struct box {
     float x = 0, y = 0, w = 0, h = 0;
 
     //
-    Vector2D middle() {
+    Vector2D middle() const {
         return Vector2D{x + w / 2.0, y + h / 2.0};
     }
-};
-struct point2 {
-    point2(const Vector2D& v) {
-        x = v.x;
-        y = v.y;
-    }
 
-    point2() {
-        x = 0;
-        y = 0;
-    }
-
-    float x = 0, y = 0;
+    bool operator==(const box&) const = default;
 };
 
 class CTrail : public IHyprWindowDecoration {
@@ -45,12 +40,60 @@ class CTrail : public IHyprWindowDecoration {
 
     virtual void                       damageEntire();
 
-  private:
-    SP<HOOK_CALLBACK_FN>                                              pTickCb;
-    void                                                              onTick();
-    void                                                              renderPass(PHLMONITOR pMonitor, const float& a);
+    // draws the trails on pMonitor with one stencil setup and as few program binds as possible
+    static void                        renderBatch(PHLMONITOR pMonitor, std::span<CTrail* const> trails);
 
-    std::deque<std::pair<box, std::chrono::system_clock::time_point>> m_dLastGeoms;
+  private:
+    // cached strip for one monitor, rebuilt when the history, the window or the monitor changes
+    struct STrailMesh {
+        uint64_t                              generation = 0;
+        PHLMONITORREF                         monitor; // the entry is dropped once it's gone
+        Vector2D                              windowMiddle;
+        Vector2D                              monitorPos;
+        Vector2D                              monitorSize;
+        float                                 monitorScale = 0;
+        CTrailHistory::clock::time_point      builtAt;
+        bool                                  instanced = false;
+        STrailGeometry                        geometry;
+        CRegion                               damage;
+
+        // GPU copy of the above, uploaded once after every rebuild
+        GLuint                                vao          = 0;
+        GLuint                                vbo          = 0;
+        bool                                  vaoInstanced = false;
+        bool                                  uploaded     = false;
+
+        bool empty() const {
+            return geometry.empty();
+        }
+
+        size_t bytes() const {
+            return instanced ? geometry.samples.size() * sizeof(STrailSample) : geometry.vertices.size() * sizeof(STrailVertex);
+        }
+    };
+
+    // returns false once there is nothing left to animate
+    bool                                                              onTick();
+    void                                                              wake();
+    void                                                              renderMask(PHLMONITOR pMonitor);
+    void                                                              renderStrip(PHLMONITOR pMonitor, STrailMesh& mesh, SShader& shader, const STrailShaderLocations& locations);
+    STrailMesh&                                                       meshFor(PHLMONITOR pMonitor, const Vector2D& windowMiddle);
+    void                                                              rebuildMesh(STrailMesh& mesh, PHLMONITOR pMonitor, const Vector2D& windowMiddle, CTrailHistory::clock::time_point now, bool instanced);
+    void                                                              bindMesh(STrailMesh& mesh);
+    void                                                              drawMesh(const STrailMesh& mesh);
+    void                                                              pruneMeshes();
+    static void                                                       destroyMesh(STrailMesh& mesh);
+
+    box                                                               historyBox(size_t i) const;
+
+    CTrailHistory                                                     m_history;
+
+    // scratch for rebuildMesh, kept to not reallocate on every rebuild
+    STrailGeometryScratch                                             m_geometryScratch;
+
+    // bumped whenever m_history changes
+    uint64_t                                                          m_iGeneration = 1;
+    std::unordered_map<MONITORID, STrailMesh>                         m_mMeshes;
 
     int                                                               m_iTimer = 0;
 
@@ -61,8 +104,15 @@ class CTrail : public IHyprWindowDecoration {
     Vector2D                                                          m_lastWindowPos;
     Vector2D                                                          m_lastWindowSize;
 
-    CBox                                                              m_bLastBox     = {0};
-    bool                                                              m_bNeedsDamage = false;
+    // what got drawn since the last tick, and what was damaged for the frame before it
+    CRegion                                                           m_rDrawnDamage;
+    CRegion                                                           m_rLastDamage;
+
+    // intrusive list of trails driven by CTrailTicker
+    CTrail*                                                           m_pPrevActive = nullptr;
+    CTrail*                                                           m_pNextActive = nullptr;
+    bool                                                              m_bTickActive = false;
 
     friend class CTrailPassElement;
+    friend class CTrailTicker;
 };